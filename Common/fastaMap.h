@@ -0,0 +1,235 @@
+/*
+* Marcus Blaisdell
+* Cpt_S 471
+*
+* fastaMap.h
+*
+* One FASTA / multi-FASTA reader for all three programs
+* (One_Programming, Two_Programming, Three_Programming).
+*
+* The file is memory mapped (private, so nothing is written back)
+* and the newlines of every record are squeezed out in place: each
+* line is found with memchr and moved down with memmove, both of
+* which the C library runs 16 - 64 bytes at a time.  A sequence
+* that is already on one line is not moved at all.  A record is two
+* views into the mapping, its name and its sequence, so nothing is
+* copied into a string and nothing is reallocated while reading;
+* loading a big reference costs about one pass over the file.
+*
+* The name is the label after '>' up to the first space.  Carriage
+* returns and trailing spaces on a line are dropped, the same as
+* cleanString.  Anything before the first '>' is skipped.
+*
+* The views point into the mapping, so they are only good until
+* the fastaFile is closed or goes away; str () makes a string.
+*
+*/
+
+#ifndef FASTAMAP_H
+#define FASTAMAP_H
+
+#include <string.h>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+using namespace std;
+
+  // fastaView: a piece of the mapped file
+
+struct fastaView
+{
+  const char *data;
+  size_t length;
+
+  string str () const
+  {
+    return string (data, length);
+  }
+};
+
+  // fastaRecord: one record of the file
+
+struct fastaRecord
+{
+  fastaView name;
+  fastaView seq;
+};
+
+struct fastaFile
+{
+  char *map;
+  size_t size;
+  vector <fastaRecord> records;
+
+  fastaFile ()
+  {
+    map = NULL;
+    size = 0;
+  }
+
+  ~fastaFile ()
+  {
+    close ();
+  }
+
+    // open: map fileName and find its records
+    // returns false if the file can't be read
+
+  bool open (string fileName)
+  {
+    struct stat info;
+    int fd = ::open (fileName.c_str (), O_RDONLY);
+
+    close ();
+
+    if (fd < 0)
+    {
+      return false;
+    }
+
+    if (fstat (fd, &info) != 0)
+    {
+      ::close (fd);
+      return false;
+    }
+
+    size = info.st_size;
+
+    if (size == 0)
+    {
+      ::close (fd);
+      return true;
+    } // end if empty, no records
+
+    void *memory = mmap (NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE,
+                         fd, 0);
+
+    ::close (fd);
+
+    if (memory == MAP_FAILED)
+    {
+      size = 0;
+      return false;
+    }
+
+    map = (char *) memory;
+
+#ifdef MADV_SEQUENTIAL
+    madvise (map, size, MADV_SEQUENTIAL);
+#endif
+
+    parse ();
+
+    return true;
+  }
+
+    // close: unmap the file, the views are gone after this
+
+  void close ()
+  {
+    if (map != NULL)
+    {
+      munmap (map, size);
+    }
+
+    map = NULL;
+    size = 0;
+    records.clear ();
+  }
+
+    // lineEnd: the end of the line starting at "from"
+    // (the newline, or the end of the file)
+
+  char *lineEnd (char *from)
+  {
+    char *end = (char *) memchr (from, '\n', (map + size) - from);
+
+    return (end == NULL) ? map + size : end;
+  }
+
+    // trimmed: the end of the line [from, end) without the
+    // carriage return and trailing spaces
+
+  static char *trimmed (char *from, char *end)
+  {
+    while (end > from && (end[-1] == '\r' || end[-1] == ' '))
+    {
+      end--;
+    }
+
+    return end;
+  }
+
+    // parse: one pass over the mapping, each label line starts a
+    // record, every other line is moved down onto the end of the
+    // sequence before it
+
+  void parse ()
+  {
+    char *read = map;
+    char *fileEnd = map + size;
+    char *write = NULL;
+
+    while (read < fileEnd)
+    {
+      char *end = lineEnd (read);
+      char *last = trimmed (read, end);
+
+      if (*read == '>')
+      {
+        fastaRecord theRecord;
+        char *label = read + 1;
+
+        while (label < last && *label != ' ')
+        {
+          label++;
+        }
+
+        if (!records.empty ())
+        {
+          records.back ().seq.length = write - records.back ().seq.data;
+        } // end if this ends the record before it
+
+        theRecord.name.data = read + 1;
+        theRecord.name.length = label - (read + 1);
+        theRecord.seq.data = end + 1;
+        theRecord.seq.length = 0;
+        records.push_back (theRecord);
+
+        write = end + 1;
+
+      } // end if label line, start a new record
+      else if (write != NULL)
+      {
+        if (write != read)
+        {
+          memmove (write, read, last - read);
+        }
+
+        write += last - read;
+
+      } // end else if more of this record
+
+      read = end + 1;
+
+    } // end while loop through the lines
+
+    if (!records.empty ())
+    {
+      if (records.back ().seq.data > fileEnd)
+      {
+        records.back ().seq.data = fileEnd;
+        write = fileEnd;
+      } // end if the file ends on the label line
+
+      records.back ().seq.length = write - records.back ().seq.data;
+    } // end finish the last record
+
+  }
+};
+
+#endif
@@ -0,0 +1,399 @@
+/*
+* Marcus Blaisdell
+* Cpt_S 471
+*
+* packedSeq.h
+*
+* A DNA sequence at 2 bits per base (A = 0, C = 1, G = 2, T = 3),
+* 32 bases to a 64 bit word, a quarter of the memory of a string.
+* Lower case a, c, g and t (soft-masked repeats) pack the same way,
+* with a bit set for them in a case mask, 1 bit per base, that is
+* only there if the text has any.  Anything else (N and the other
+* ambiguity codes, the '$' at the end of a suffix tree text) is
+* marked in a side mask, 1 bit per base, and kept as it was in a
+* short list of runs (where a run of the same character starts,
+* how long it is, and the character), so base (i) and str () give
+* back the exact text; a scaffold with long stretches of N takes a
+* run per stretch, not an entry per N.
+*
+* commonPrefix compares 32 bases at a time: XOR two words, and the
+* lowest set bit is the first base that differs; the same for the
+* 32 bits of the case masks, so 'a' and 'A' still differ.  Words
+* with a masked base in them are compared one base at a time.
+*
+* Text whose odd runs would take more room than it does as it is
+* (a protein, where nearly every residue starts a run) is kept as
+* plain text instead, every base counts as masked, and str () is a
+* copy.
+*
+*/
+
+#ifndef PACKEDSEQ_H
+#define PACKEDSEQ_H
+
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+using namespace std;
+
+#define PACKED_BASES 32
+
+  // packedOdd: a run of "count" bases from pos that are all the
+  // same character, not A, C, G or T (either case), and what it was
+
+struct packedOdd
+{
+  size_t pos;
+  size_t count;
+  char base;
+
+  bool operator< (const packedOdd &other) const
+  {
+    return pos < other.pos;
+  }
+};
+
+struct packedSeq
+{
+  size_t length;
+  vector <uint64_t> bits;
+  vector <uint64_t> mask;
+  vector <uint64_t> lower;
+  vector <packedOdd> odd;
+  bool isPlain;
+  string plain;
+
+  packedSeq ()
+  {
+    length = 0;
+    isPlain = false;
+  }
+
+  packedSeq (const char *data, size_t theLength)
+  {
+    assign (data, theLength);
+  }
+
+  packedSeq (const string &data)
+  {
+    assign (data.data (), data.length ());
+  }
+
+    // code: 2 bit code of c (either case), or -1 if c is not A, C,
+    // G or T
+
+  static int code (char c)
+  {
+    switch (c)
+    {
+      case 'A': case 'a': return 0;
+      case 'C': case 'c': return 1;
+      case 'G': case 'g': return 2;
+      case 'T': case 't': return 3;
+    }
+
+    return -1;
+  }
+
+  void assign (const char *data, size_t theLength)
+  {
+    size_t runCount = 0, lowerCount = 0;
+
+    length = theLength;
+    odd.clear ();
+    plain.clear ();
+
+    for (size_t i = 0; i < length; i++)
+    {
+      int c = code (data[i]);
+
+      runCount += (c < 0 && (i == 0 || data[i-1] != data[i]) );
+      lowerCount += (c >= 0 && data[i] >= 'a');
+    }
+
+    isPlain = (runCount * sizeof (packedOdd) > length);
+
+    if (isPlain)
+    {
+      bits.clear ();
+      mask.clear ();
+      lower.clear ();
+      plain.assign (data, length);
+      return;
+    } // end if mostly not DNA, keep the text
+
+    bits.assign ( (length + PACKED_BASES - 1) / PACKED_BASES, 0);
+    mask.assign ( (length + 63) / 64, 0);
+    lower.assign ( (lowerCount > 0) ? (length + 63) / 64 : 0, 0);
+
+    for (size_t i = 0; i < length; i++)
+    {
+      int c = code (data[i]);
+
+      if (c < 0)
+      {
+        if (!odd.empty () && odd.back ().pos + odd.back ().count == i &&
+            odd.back ().base == data[i])
+        {
+          odd.back ().count++;
+        }
+        else
+        {
+          packedOdd theOdd;
+
+          theOdd.pos = i;
+          theOdd.count = 1;
+          theOdd.base = data[i];
+          odd.push_back (theOdd);
+        } // end else a new run
+
+        mask[i / 64] |= (uint64_t) 1 << (i % 64);
+        c = 0;
+      } // end if not A, C, G or T
+      else if (data[i] >= 'a')
+      {
+        lower[i / 64] |= (uint64_t) 1 << (i % 64);
+      } // end else if lower case
+
+      bits[i / PACKED_BASES] |= (uint64_t) c << (2 * (i % PACKED_BASES));
+
+    } // end for each base
+  }
+
+  size_t size () const
+  {
+    return length;
+  }
+
+  bool isOdd (size_t i) const
+  {
+    return isPlain || ( (mask[i / 64] >> (i % 64)) & 1);
+  }
+
+    // base: the character at position i
+
+  char base (size_t i) const
+  {
+    if (isPlain)
+    {
+      return plain[i];
+    }
+
+    if (isOdd (i))
+    {
+      packedOdd key;
+
+      key.pos = i;
+
+      return (upper_bound (odd.begin (), odd.end (), key) - 1)->base;
+    } // end if masked, look it up in the last run that starts by i
+
+    int c = (bits[i / PACKED_BASES] >> (2 * (i % PACKED_BASES))) & 3;
+
+    return (caseBits (i) & 1) ? "acgt"[c] : "ACGT"[c];
+  }
+
+  char operator[] (size_t i) const
+  {
+    return base (i);
+  }
+
+    // str: "count" bases from "start" as a string (all of it by default)
+
+  string str (size_t start = 0, size_t count = (size_t) -1) const
+  {
+    string theString;
+
+    if (start > length)
+    {
+      start = length;
+    }
+    if (count > length - start)
+    {
+      count = length - start;
+    }
+
+    if (isPlain)
+    {
+      return plain.substr (start, count);
+    }
+
+    theString.resize (count);
+
+    for (size_t k = 0; k < count; k++)
+    {
+      theString[k] = base (start + k);
+    }
+
+    return theString;
+  }
+
+    // word: the 32 bases from position i (2 bits each, base i in
+    // the low bits), past the end reads as A
+
+  uint64_t word (size_t i) const
+  {
+    size_t w = i / PACKED_BASES;
+    int shift = 2 * (i % PACKED_BASES);
+    uint64_t low = bits[w] >> shift;
+
+    if (shift > 0 && w + 1 < bits.size ())
+    {
+      low |= bits[w + 1] << (64 - shift);
+    }
+
+    return low;
+  }
+
+    // caseBits: the case mask of the 32 bases from position i (bit k
+    // set if base i + k is lower case), 0 if the text has none
+
+  uint64_t caseBits (size_t i) const
+  {
+    if (lower.empty ())
+    {
+      return 0;
+    }
+
+    size_t w = i / 64;
+    int from = i % 64;
+    uint64_t low = lower[w] >> from;
+
+    if (from > 0 && w + 1 < lower.size ())
+    {
+      low |= lower[w + 1] << (64 - from);
+    }
+
+    return low & 0xffffffff;
+  }
+
+    // oddIn: true if any of the "count" bases from i is masked
+
+  bool oddIn (size_t i, size_t count) const
+  {
+    if (isPlain)
+    {
+      return count > 0;
+    }
+
+    if (odd.empty ())
+    {
+      return false;
+    }
+
+    for (size_t k = i; k < i + count; )
+    {
+      size_t w = k / 64;
+      int from = k % 64;
+      size_t take = 64 - from;
+      uint64_t bitsThere = mask[w] >> from;
+
+      if (take > i + count - k)
+      {
+        take = i + count - k;
+      }
+
+      if (take < 64)
+      {
+        bitsThere &= ( (uint64_t) 1 << take) - 1;
+      }
+
+      if (bitsThere != 0)
+      {
+        return true;
+      }
+
+      k += take;
+    } // end for each mask word
+
+    return false;
+  }
+
+    // commonPrefix: how many bases from i in this sequence match the
+    // bases from j in "other", at most "limit" (and never past the
+    // end of either)
+
+  size_t commonPrefix (size_t i, const packedSeq &other, size_t j,
+                       size_t limit) const
+  {
+    size_t matched = 0;
+
+    if (limit > length - i)
+    {
+      limit = length - i;
+    }
+    if (limit > other.length - j)
+    {
+      limit = other.length - j;
+    }
+
+    while (matched < limit)
+    {
+      size_t count = limit - matched;
+
+      if (count > PACKED_BASES)
+      {
+        count = PACKED_BASES;
+      }
+
+      if (oddIn (i + matched, count) || other.oddIn (j + matched, count))
+      {
+        for (size_t k = 0; k < count; k++)
+        {
+          if (base (i + matched) != other.base (j + matched))
+          {
+            return matched;
+          }
+
+          matched++;
+        }
+
+        continue;
+      } // end if masked bases, one at a time
+
+      uint64_t diff = word (i + matched) ^ other.word (j + matched);
+      uint64_t caseDiff = caseBits (i + matched) ^ other.caseBits (j + matched);
+
+      if (count < PACKED_BASES)
+      {
+        diff &= ( (uint64_t) 1 << (2 * count)) - 1;
+        caseDiff &= ( (uint64_t) 1 << count) - 1;
+      }
+
+      if (diff != 0 || caseDiff != 0)
+      {
+        size_t at = (diff != 0) ? __builtin_ctzll (diff) / 2 : count;
+
+        if (caseDiff != 0 && (size_t) __builtin_ctzll (caseDiff) < at)
+        {
+          at = __builtin_ctzll (caseDiff);
+        }
+
+        return matched + at;
+      } // end if a base or its case differs
+
+      matched += count;
+
+    } // end while the bases match
+
+    return matched;
+  }
+
+  size_t commonPrefix (size_t i, size_t j, size_t limit) const
+  {
+    return commonPrefix (i, *this, j, limit);
+  }
+
+    // bytes: memory held by the packed bases and the masks
+
+  size_t bytes () const
+  {
+    return (bits.size () + mask.size () + lower.size ()) * sizeof (uint64_t) +
+           odd.size () * sizeof (packedOdd) + plain.size ();
+  }
+};
+
+#endif
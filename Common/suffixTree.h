@@ -0,0 +1,200 @@
+/*
+* Marcus Blaisdell
+* Cpt_S 471
+*
+* suffixTree.h
+*
+* A suffix tree of a text that ends in a character found nowhere
+* else in it ('$'), built in linear time with suffix links
+* (McCreight, the same cases as buildSFTree in Programming
+* Assignment 2: scan down from the locus of the last head, or hop
+* down from the suffix link of its parent).
+*
+* It is kept small enough for texts of a few million characters:
+* the nodes are in one vector and point at each other by index, an
+* edge label is only where it is in the text, and the children of a
+* node are a list (first child, next sibling) instead of a vector
+* each.  A node is 6 ints, at most 2 n of them, so about 48 bytes a
+* character of the text.
+*
+* Every node keeps "pos", the start of one suffix whose path goes
+* through it, and its string depth; the label of the edge into it
+* is then text[pos + depth of the parent .. pos + depth - 1].  A leaf
+* is the suffix starting at its pos.
+*
+*/
+
+#ifndef SUFFIXTREE_H
+#define SUFFIXTREE_H
+
+#include <string.h>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+  // stNode: one node of the tree
+  // link: the suffix link, -1 while not known
+  // child: the first child, -1 for a leaf
+  // sibling: the next child of the parent, -1 for the last
+
+struct stNode
+{
+  int pos;
+  int depth;
+  int parent;
+  int link;
+  int child;
+  int sibling;
+};
+
+struct suffixTree
+{
+  string text;
+  vector <stNode> nodes;
+
+  suffixTree (const string &theText)
+  {
+    build (theText);
+  }
+
+  bool isLeaf (int v) const
+  {
+    return nodes[v].child < 0;
+  }
+
+    // findChild: the child of v whose edge starts with c, -1 if none
+
+  int findChild (int v, char c) const
+  {
+    int depth = nodes[v].depth;
+
+    for (int w = nodes[v].child; w >= 0; w = nodes[w].sibling)
+    {
+      if (text[nodes[w].pos + depth] == c)
+      {
+        return w;
+      }
+    }
+
+    return -1;
+  }
+
+    // split: a new node at string depth d on the edge into v,
+    // between v and its parent; returns the new node
+
+  int split (int v, int d)
+  {
+    int w = nodes.size ();
+    int parent = nodes[v].parent;
+    stNode theNode = { nodes[v].pos, d, parent, -1, v, nodes[v].sibling };
+
+    nodes.push_back (theNode);
+
+    if (nodes[parent].child == v)
+    {
+      nodes[parent].child = w;
+    }
+    else
+    {
+      int c = nodes[parent].child;
+
+      while (nodes[c].sibling != v)
+      {
+        c = nodes[c].sibling;
+      }
+
+      nodes[c].sibling = w;
+    } // end else, v is further down the list
+
+    nodes[v].parent = w;
+    nodes[v].sibling = -1;
+
+    return w;
+  }
+
+    // addLeaf: the leaf of the suffix starting at i, under v
+
+  void addLeaf (int v, int i)
+  {
+    stNode theLeaf = { i, (int) text.length () - i, v, -1, -1,
+                       nodes[v].child };
+
+    nodes[v].child = nodes.size ();
+    nodes.push_back (theLeaf);
+  }
+
+    // build: the tree of theText, which must end in a character
+    // found nowhere else in it
+    // u is the locus of the head of the last suffix, d how far down
+    // it the head goes (the head ends on u unless it was split)
+
+  void build (const string &theText)
+  {
+    int n = theText.length ();
+    int u = 0, d = 0;
+    stNode root = { 0, 0, 0, 0, -1, -1 };
+
+    text = theText;
+    nodes.clear ();
+    nodes.reserve (2 * (size_t) n + 1);
+    nodes.push_back (root);
+
+    for (int i = 0; i < n; i++)
+    {
+        // scan: match text[i + d ..] down from u, a character at a
+        // time
+
+      while (d == nodes[u].depth)
+      {
+        int w = findChild (u, text[i + d]);
+
+        if (w < 0)
+        {
+          break;
+        }
+
+        u = w;
+        d++;
+
+        while (d < nodes[u].depth && text[nodes[u].pos + d] == text[i + d])
+        {
+          d++;
+        }
+      } // end while the head goes on through u
+
+      if (d < nodes[u].depth)
+      {
+        u = split (u, d);
+      } // end if the head ends inside an edge
+
+      addLeaf (u, i);
+
+        // a new node's suffix link: hop down from the link of its
+        // parent, an edge at a time (the path is known to be there)
+
+      if (nodes[u].link < 0)
+      {
+        int v = nodes[nodes[u].parent].link;
+
+        while (nodes[v].depth < d - 1)
+        {
+          v = findChild (v, text[i + 1 + nodes[v].depth]);
+        }
+
+        if (nodes[v].depth > d - 1)
+        {
+          v = split (v, d - 1);
+        }
+
+        nodes[u].link = v;
+      } // end if the suffix link isn't known
+
+      u = nodes[u].link;
+      d = nodes[u].depth;
+
+    } // end for each suffix
+  }
+};
+
+#endif
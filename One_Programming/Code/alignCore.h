@@ -0,0 +1,328 @@
+/*
+* Cpt_S 471
+* Programming Assignment #1
+*
+* alignCore.h
+*
+* Pieces shared by every alignment mode: the DP cell structs,
+* the scoring function S, and the helpers that count and print
+* a finished alignment
+*
+*/
+
+#ifndef ALIGNCORE_H
+#define ALIGNCORE_H
+
+#include <string.h>
+#include <iostream>
+#include <vector>
+#include <iomanip>
+#include <climits>
+
+using namespace std;
+
+struct DP_cell
+{
+  int score;
+};
+
+  // minus infinity for the int scores of the tables, far enough
+  // from INT_MIN that adding a few penalties can't wrap around
+  // (the narrower SIMD scores have their own, scoreWidth.h)
+
+#define ADP_MINUS_INFINITY (INT_MIN / 4)
+
+  // the alignment modes, the same numbers as the argv switch
+  // ALIGN_SEMIGLOBAL: all of S1 against a piece of S2 (the gaps
+  // before and after it in S2 are free), a read against a window
+
+#define ALIGN_GLOBAL 0
+#define ALIGN_LOCAL 1
+#define ALIGN_SEMIGLOBAL 2
+
+struct ADP_cell
+{
+  int sub_score;
+  int del_score;
+  int ins_score;
+};
+
+  // cleanString function:
+  // removes trailing whitespace from a string
+
+string cleanString (string line)
+{
+
+  while (line.length () > 0 && line.back() == ' ')
+  {
+    line.pop_back ();
+  } // end remove any trailing spaces
+
+  return line;
+
+} // end cleanString function
+
+  // reverseString
+
+string reverseString (string theString)
+{
+  char holdChar;
+  int i = 0;
+  int j = theString.length () - 1;
+
+  while (i < j)
+  {
+    holdChar = theString[i];
+    theString[i] = theString[j];
+    theString[j] = holdChar;
+
+    i++;
+    j--;
+
+  } // end swap chars
+
+  return theString;
+
+} // end reverseString function
+
+// reverseString
+
+vector <char> reverseVector (vector <char> theVector)
+{
+char holdChar;
+int i = 0;
+int j = theVector.size () - 1;
+
+while (i < j)
+{
+  holdChar = theVector[i];
+  theVector[i] = theVector[j];
+  theVector[j] = holdChar;
+
+  i++;
+  j--;
+
+} // end swap chars
+
+return theVector;
+
+} // end reverseVector function
+
+  // S function: (calculate a match score for S1 and S2)
+
+int S (char S1, char S2, int match, int mismatch)
+{
+  //int match = 1;
+  //int mismatch = -2;
+
+  if (S1 == S2)
+  {
+    return match;
+  } // end if match, return value assigned to "match"
+  else
+  {
+    return mismatch;
+  } // end else, return the mismatch value
+
+} // end S function
+
+  // maxState function:
+  // returns which of the three scores in a cell is the highest,
+  // 0 = substitution, 1 = deletion, 2 = insertion
+  // ties go to the lowest number, so every traceback that
+  // uses this picks the same path through equal scores
+
+int maxState (ADP_cell theCell)
+{
+  int state = 0;
+  int max = theCell.sub_score;
+
+  if (theCell.del_score > max)
+  {
+    max = theCell.del_score;
+    state = 1;
+  } // end if deletion is higher
+
+  if (theCell.ins_score > max)
+  {
+    state = 2;
+  } // end if insertion is higher
+
+  return state;
+
+} // end maxState function
+
+  // cellMax function:
+  // returns the highest of the three scores in a cell
+
+int cellMax (ADP_cell theCell)
+{
+  int max = theCell.sub_score;
+
+  if (theCell.del_score > max)
+  {
+    max = theCell.del_score;
+  }
+
+  if (theCell.ins_score > max)
+  {
+    max = theCell.ins_score;
+  }
+
+  return max;
+
+} // end cellMax function
+
+  // buildLink function:
+  // builds the "|" / " " row that goes between
+  // the two aligned sequences
+
+vector <char> buildLink (vector <char> &theS1, vector <char> &theS2)
+{
+  vector <char> theLink;
+
+  for (int a = 0; a < (int) theS1.size (); a++)
+  {
+    if (theS1[a] != '-' && theS1[a] == theS2[a])
+    {
+      theLink.push_back ('|');
+    } // end if match
+    else
+    {
+      theLink.push_back (' ');
+    } // end else, mismatch or gap
+
+  } // end for each column
+
+  return theLink;
+
+} // end buildLink function
+
+  // tallyAlignment function:
+  // counts matches, mismatches, gaps and opening gaps
+  // of a finished alignment (in left to right order)
+  // every gap character counts as a gap, and every run
+  // of gaps in one sequence counts as one opening gap
+  // (one h penalty), so the score of the alignment is
+  // always:
+  // match * matches + mismatch * mismatches + h * openingGaps + g * gaps
+  // (a gap never opens right after a gap in the same
+  // sequence, even with h > 0, so a run is one opening)
+
+void tallyAlignment (vector <char> &theS1, vector <char> &theS2,
+                      int *matchCount, int *mismatchCount,
+                      int *gapCount, int *openingGap)
+{
+    // lastPos: 0 = substitution, 1 = deletion, 2 = insertion
+
+  int lastPos = 0;
+  int thisPos = 0;
+
+  for (int a = 0; a < (int) theS1.size (); a++)
+  {
+    if (theS2[a] == '-')
+    {
+      thisPos = 1;
+    } // end if deletion
+    else if (theS1[a] == '-')
+    {
+      thisPos = 2;
+    } // end else if insertion
+    else
+    {
+      thisPos = 0;
+
+      if (theS1[a] == theS2[a])
+      {
+        *matchCount = *matchCount + 1;
+      } // end if match
+      else
+      {
+        *mismatchCount = *mismatchCount + 1;
+      } // end else, mismatch
+
+    } // end else, substitution
+
+    if (thisPos != 0)
+    {
+      *gapCount = *gapCount + 1;
+
+      if (thisPos != lastPos)
+      {
+        *openingGap = *openingGap + 1;
+      } // end if this gap starts a new run
+
+    } // end if gap
+
+    lastPos = thisPos;
+
+  } // end for each column
+
+} // end tallyAlignment function
+
+  // printAlignment function:
+  // prints the alignment in rows of 60 characters
+  // with the sequence positions at each end of the row
+
+void printAlignment (vector <char> &theS1, vector <char> &theLink,
+                      vector <char> &theS2)
+{
+  int total = theLink.size ();
+  int S1Index = 0, S2Index = 0, linkIndex = 0;
+  int rowSize = 60, rowStart = 0;
+
+  while (linkIndex < total)
+  {
+    if ((total - linkIndex) < 60)
+    {
+      rowSize = total - linkIndex;
+    }
+
+    ////////////////////////////////////////////
+      // S1
+    cout << "S1 " << setw(5) << S1Index << " ";
+    for (rowStart = 0; rowStart < rowSize; rowStart++)
+    {
+      if (theS1[linkIndex + rowStart] != '-')
+      {
+        S1Index++;
+      } // end increment S1Index
+
+      cout << theS1[linkIndex + rowStart];
+    } // end for loop to print 60 (or fewer) characters from theS1
+
+    cout << setw(5) << S1Index << endl;
+    S1Index++;
+    ////////////////////////////////////////////
+    cout << setw(10);
+    for (rowStart = 0; rowStart < rowSize; rowStart++)
+    {
+      cout << theLink[linkIndex + rowStart];
+
+    } // end for loop to print 60 (or fewer) characters from theLink
+
+    cout << endl;
+    ////////////////////////////////////////////
+    cout << "S2 " << setw(5) << S2Index << " ";
+    for (rowStart = 0; rowStart < rowSize; rowStart++)
+    {
+      if (theS2[linkIndex + rowStart] != '-')
+      {
+        S2Index++;
+      } // end increment S2Index
+
+      cout << theS2[linkIndex + rowStart];
+
+    } // end for loop to print 60 (or fewer) characters from theS2
+
+    cout << setw(5) << S2Index << endl << endl;
+    S2Index++;
+    ////////////////////////////////////////////
+
+    linkIndex += rowSize;
+
+  } // end while to print all characters
+
+} // end printAlignment function
+
+#endif
@@ -0,0 +1,349 @@
+/*
+* Cpt_S 471
+* Programming Assignment #1
+*
+* anchored.h
+*
+* Global alignment of two long, similar sequences (Human - Mouse
+* BRCA2 and other orthologs) from anchors, in close to linear time
+* instead of the whole n x m fill:
+*
+*   1. the maximal unique matches (MUMs) of S1 and S2, from the
+*      suffix tree of S1 # S2 $ (../../Common/suffixTree.h): an
+*      internal node with just two leaves under it, one from each
+*      sequence, whose characters before them differ, and at least
+*      minLength deep
+*   2. the chain of them that goes forward in both sequences with
+*      the most bases (the heaviest increasing run of S2 positions
+*      in the order of S1); where two in the chain overlap, the
+*      front of the later one is cut off
+*   3. the affine DP only in the gaps between the anchors
+*      (alignPlanned, planner.h, so a big gap still fits the memory
+*      budget); each anchor is a run of matches
+*
+* The score is the sum of the pieces, the CIGAR the pieces one after
+* another.  It is the best alignment through the anchors, which is
+* not always the best one over all: a pair that is not that close
+* gets few, short anchors and big gaps, and a pair with none at all
+* is one gap, the full DP.
+*
+*/
+
+#ifndef ANCHORED_H
+#define ANCHORED_H
+
+#include <string.h>
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include "alignCore.h"
+#include "cigar.h"
+#include "planner.h"
+#include "dpArena.h"
+#include "scoring.h"
+#include "runStats.h"
+#include "../../Common/suffixTree.h"
+
+using namespace std;
+
+  // shortest MUM used as an anchor, if none is given
+
+#define ANCHOR_MIN_LENGTH 20
+
+  // mumAnchor: S1[i..i + length - 1] is S2[j..j + length - 1]
+
+struct mumAnchor
+{
+  int i;
+  int j;
+  int length;
+
+  bool operator< (const mumAnchor &other) const
+  {
+    return i < other.i;
+  }
+};
+
+  // anchorSummary: what alignAnchored found, for the report
+  // widestI x widestJ: the biggest gap (in cells) filled by the DP
+
+struct anchorSummary
+{
+  int mums;
+  int anchors;
+  long long anchored;
+  int widestI;
+  int widestJ;
+};
+
+  // findMums function:
+  // the MUMs of S1 and S2 at least minLength long, in the order of S1
+  // the tree is gone when it returns
+  // returns the number found
+
+int findMums (string &S1, string &S2, int minLength, vector <mumAnchor> &mums)
+{
+  int n = S1.length ();
+  suffixTree tree (S1 + "#" + S2 + "$");
+
+  statsBytes (tree.nodes.capacity () * sizeof (stNode) + tree.text.length ());
+  mums.clear ();
+
+  for (size_t v = 1; v < tree.nodes.size (); v++)
+  {
+    stNode &theNode = tree.nodes[v];
+
+    if (tree.isLeaf (v) || theNode.depth < minLength)
+    {
+      continue;
+    }
+
+    int a = theNode.child;
+    int b = tree.nodes[a].sibling;
+
+    if (b < 0 || tree.nodes[b].sibling >= 0 ||
+        !tree.isLeaf (a) || !tree.isLeaf (b) )
+    {
+      continue;
+    } // end if not just two leaves
+
+    int posA = tree.nodes[a].pos;
+    int posB = tree.nodes[b].pos;
+
+    if (posA > posB)
+    {
+      swap (posA, posB);
+    }
+
+    if (posA >= n || posB <= n)
+    {
+      continue;
+    } // end if both in the same sequence
+
+    mumAnchor theMum = { posA, posB - n - 1, theNode.depth };
+
+    if (theMum.i > 0 && theMum.j > 0 && S1[theMum.i - 1] == S2[theMum.j - 1])
+    {
+      continue;
+    } // end if it goes on to the left
+
+    mums.push_back (theMum);
+
+  } // end for each node
+
+  sort (mums.begin (), mums.end ());
+
+  return mums.size ();
+
+} // end findMums function
+
+  // chainAnchors function:
+  // the chain of mums (in the order of S1) going forward in S2 too
+  // with the most bases, without overlaps; m is the length of S2
+  // a Fenwick tree over the S2 positions gives the best chain ending
+  // before each one
+  // returns the bases in the chain
+
+long long chainAnchors (vector <mumAnchor> &mums, int m,
+                        vector <mumAnchor> &chain)
+{
+  int count = mums.size ();
+  vector <long long> best (count, 0);
+  vector <int> before (count, -1);
+  vector <long long> treeBest (m + 1, 0);
+  vector <int> treeAt (m + 1, -1);
+  int last = -1;
+
+  chain.clear ();
+
+  for (int k = 0; k < count; k++)
+  {
+    long long theBest = 0;
+    int theAt = -1;
+
+      // the best chain among S2 positions below mums[k].j
+
+    for (int p = mums[k].j; p > 0; p -= p & (-p))
+    {
+      if (treeBest[p] > theBest)
+      {
+        theBest = treeBest[p];
+        theAt = treeAt[p];
+      }
+    }
+
+    best[k] = theBest + mums[k].length;
+    before[k] = theAt;
+
+    for (int p = mums[k].j + 1; p <= m; p += p & (-p))
+    {
+      if (best[k] > treeBest[p])
+      {
+        treeBest[p] = best[k];
+        treeAt[p] = k;
+      }
+    }
+
+    if (last < 0 || best[k] > best[last])
+    {
+      last = k;
+    }
+
+  } // end for each MUM, in the order of S1
+
+  for (int k = last; k >= 0; k = before[k])
+  {
+    chain.push_back (mums[k]);
+  }
+
+  reverse (chain.begin (), chain.end ());
+
+    // cut the overlaps off the front of the later anchor
+
+  long long bases = 0;
+  int endI = 0, endJ = 0;
+  size_t kept = 0;
+
+  for (size_t k = 0; k < chain.size (); k++)
+  {
+    mumAnchor theAnchor = chain[k];
+    int cut = max (0, max (endI - theAnchor.i, endJ - theAnchor.j) );
+
+    if (cut >= theAnchor.length)
+    {
+      continue;
+    } // end if nothing is left of it
+
+    theAnchor.i += cut;
+    theAnchor.j += cut;
+    theAnchor.length -= cut;
+    chain[kept++] = theAnchor;
+
+    endI = theAnchor.i + theAnchor.length;
+    endJ = theAnchor.j + theAnchor.length;
+    bases += theAnchor.length;
+  } // end for each anchor of the chain
+
+  chain.resize (kept);
+
+  return bases;
+
+} // end chainAnchors function
+
+  // addRun function:
+  // "length" columns of "op" at the end of a CIGAR, joined to the
+  // last run if it is the same op
+
+static void addRun (vector <uint32_t> &cigar, int op, int length)
+{
+  if (length <= 0)
+  {
+    return;
+  }
+
+  if (!cigar.empty () && cigarOp (cigar.back ()) == op)
+  {
+    cigar.back () += (uint32_t) length << 4;
+  }
+  else
+  {
+    cigar.push_back ( (uint32_t) length << 4 | op);
+  }
+
+} // end addRun function
+
+  // alignAnchored function:
+  // the global alignment of S1 and S2 through the chained MUMs at
+  // least minLength long, the gaps between them aligned by
+  // alignPlanned in "budget" bytes
+  // summary (if not NULL) gets what was found
+  // returns the score (also in result.score)
+
+int alignAnchored (string &S1, string &S2, scoreScheme &scoring, int g, int h,
+                    int minLength, size_t budget, dpArena &arena,
+                    alignResult &result, anchorSummary *summary = NULL)
+{
+  int n = S1.length ();
+  int m = S2.length ();
+  vector <mumAnchor> mums, chain;
+  anchorSummary theSummary = { 0, 0, 0, 0, 0 };
+
+  statsMark ();
+
+  theSummary.mums = findMums (S1, S2, minLength, mums);
+  theSummary.anchored = chainAnchors (mums, m, chain);
+  theSummary.anchors = chain.size ();
+
+  statsLap (STATS_INIT);
+
+  int score = 0;
+  int i = 0, j = 0;
+
+  result.cigar.clear ();
+
+  for (size_t k = 0; k <= chain.size (); k++)
+  {
+    int endI = (k < chain.size ()) ? chain[k].i : n;
+    int endJ = (k < chain.size ()) ? chain[k].j : m;
+
+    if (endI > i || endJ > j)
+    {
+      string A = S1.substr (i, endI - i);
+      string B = S2.substr (j, endJ - j);
+      alignResult thePiece;
+
+      score += alignPlanned (A, B, scoring, g, h, ALIGN_GLOBAL, budget,
+                             arena, thePiece);
+
+      for (size_t r = 0; r < thePiece.cigar.size (); r++)
+      {
+        addRun (result.cigar, cigarOp (thePiece.cigar[r]),
+                cigarLength (thePiece.cigar[r]));
+      }
+
+      if ( (long long) (endI - i) * (endJ - j) >=
+           (long long) theSummary.widestI * theSummary.widestJ)
+      {
+        theSummary.widestI = endI - i;
+        theSummary.widestJ = endJ - j;
+      }
+    } // end if a gap before the anchor
+
+    if (k == chain.size ())
+    {
+      break;
+    }
+
+    for (int c = 0; c < chain[k].length; c++)
+    {
+      score += scoring.table (S1[endI + c], S2[endJ + c]);
+    }
+
+    addRun (result.cigar, CIGAR_MATCH, chain[k].length);
+
+    i = endI + chain[k].length;
+    j = endJ + chain[k].length;
+
+  } // end for each anchor and the gap before it
+
+    // cigarFinish takes the runs last first, as the backtrace
+    // hands them over
+
+  cigarPath path = { S1, S2, result.cigar, 0, 0 };
+
+  reverse (result.cigar.begin (), result.cigar.end ());
+  cigarFinish (path, result);
+  result.endI = n;
+  result.endJ = m;
+  result.score = score;
+
+  if (summary != NULL)
+  {
+    *summary = theSummary;
+  }
+
+  return score;
+
+} // end alignAnchored function
+
+#endif
@@ -0,0 +1,456 @@
+/*
+* Cpt_S 471
+* Programming Assignment #1
+*
+* banded.h
+*
+* Banded global alignment: only the cells within a band around
+* the diagonal are filled, so time and memory are O(n * k)
+* instead of O(n * m).  The band covers offsets (j - i) from
+* min(0, m - n) - k to max(0, m - n) + k, so it always holds
+* both corners.  Cells are filled by globalCell (wavefront.h), the
+* same as runGlobal, and their codes walked back by tracePath
+* (traceback.h).  If the traceback
+* runs along the edge of the band, the best alignment may lie
+* outside it, so the band is doubled and the table refilled.
+* Once it stays inside, the score is checked against the best
+* any path leaving the band could do (bandNeeded); if that could
+* be higher, the band is widened to where it can't.  So the
+* alignment is always the same one runGlobal finds.  Every try
+* counts in the stats (runStats.h): the cells of each band filled,
+* the memory of the widest.
+*
+*/
+
+#ifndef BANDED_H
+#define BANDED_H
+
+#include <string.h>
+#include <iostream>
+#include <vector>
+#include <climits>
+#include "alignCore.h"
+#include "traceback.h"
+#include "wavefront.h"
+#include "cigar.h"
+#include "scoring.h"
+#include "runStats.h"
+
+using namespace std;
+
+  // score for cells outside the band
+
+#define BAND_MINUS_INFINITY ADP_MINUS_INFINITY
+
+  // default half width of the band, if none is given
+
+#define BAND_DEFAULT_WIDTH 64
+
+  // bandTable: rows 0..n-1, each holding the columns with
+  // lo <= j - i <= hi, the scores and traceback code of each
+
+struct bandTable
+{
+  int n, m;
+  int lo, hi, width;
+  vector <ADP_cell> cells;
+  vector <unsigned char> codes;
+  ADP_cell outside;
+
+  bandTable (int theN, int theM, int k)
+  {
+    n = theN;
+    m = theM;
+    lo = ( (m < n) ? (m - n) : 0) - k;
+    hi = ( (m > n) ? (m - n) : 0) + k;
+
+      // no need for a band wider than the table
+
+    if (lo < -(n - 1))
+    {
+      lo = -(n - 1);
+    }
+    if (hi > m - 1)
+    {
+      hi = m - 1;
+    }
+
+    width = hi - lo + 1;
+    cells.resize ( (size_t) n * width);
+    codes.resize ( (size_t) n * width);
+
+    outside.sub_score = BAND_MINUS_INFINITY;
+    outside.del_score = BAND_MINUS_INFINITY;
+    outside.ins_score = BAND_MINUS_INFINITY;
+  }
+
+  bool inBand (int i, int j)
+  {
+    return (j >= 0) && (j < m) && (j - i >= lo) && (j - i <= hi);
+  }
+
+    // the cell, or the "outside" cell if (i,j) is not in the band
+
+  ADP_cell &at (int i, int j)
+  {
+    if (!inBand (i, j))
+    {
+      return outside;
+    }
+
+    return cells[ (size_t) i * width + (j - i - lo)];
+  }
+
+    // get: the code of T(i,j), the same as traceMatrix::get
+    // outside the band a substitution, so a walk there still ends
+
+  int get (int i, int j)
+  {
+    if (i <= 0 || j <= 0)
+    {
+      return TRACE_ZERO;
+    }
+
+    if (!inBand (i, j))
+    {
+      return TRACE_DEL_EXTEND | TRACE_INS_EXTEND;
+    }
+
+    return codes[ (size_t) i * width + (j - i - lo)];
+  }
+
+    // true if a neighbor of (i,j) is in the table but not in the band,
+    // so the traceback through (i,j) may have missed a better path
+
+  bool onEdge (int i, int j)
+  {
+    return ( (j - i == lo) && (j > 0) ) || ( (j - i == hi) && (i > 0) );
+  }
+};
+
+  // bandBytes function:
+  // memory of the bandTable for a band of half width k
+
+size_t bandBytes (int n, int m, int k)
+{
+  int lo = ( (m < n) ? (m - n) : 0) - k;
+  int hi = ( (m > n) ? (m - n) : 0) + k;
+
+  lo = (lo < -(n - 1)) ? -(n - 1) : lo;
+  hi = (hi > m - 1) ? m - 1 : hi;
+
+  return (size_t) n * (hi - lo + 1) * (sizeof (ADP_cell) + 1);
+
+} // end bandBytes function
+
+  // bandCell function:
+  // T(i,j) and its code by globalCell, as runGlobal fills it
+  // subRow: the scores of S1[i-1] against every code (scoring.h)
+
+void bandCell (bandTable &T, string &S2, const int *subRow, int i, int j,
+                int g, int h)
+{
+  T.codes[ (size_t) i * T.width + (j - i - T.lo)] =
+    globalCell (T.at (i-1, j-1), T.at (i-1, j), T.at (i, j-1),
+                subRow[scoreCode (S2[j-1])], g, h, T.at (i, j));
+
+} // end bandCell function
+
+  // fillBand function:
+  // sets the zeroeth row and column the way runGlobal does,
+  // then fills every other cell of the band row by row
+  // sub: the substitution scorer (scoring.h)
+
+template <class SCORER>
+void fillBand (bandTable &T, string &S1, string &S2,
+                const SCORER &sub, int g, int h)
+{
+  int i = 0, j = 0;
+
+  for (i = 0; i < T.n; i++)
+  {
+    const int *subRow = (i > 0) ? sub.row (S1[i-1]) : NULL;
+    int jStart = i + T.lo;
+    int jEnd = i + T.hi;
+
+    if (jStart < 0)
+    {
+      jStart = 0;
+    }
+    if (jEnd > T.m - 1)
+    {
+      jEnd = T.m - 1;
+    }
+
+    for (j = jStart; j <= jEnd; j++)
+    {
+      ADP_cell &cell = T.at (i, j);
+
+      if (i == 0 && j == 0)
+      {
+        cell.sub_score = 0;
+        cell.del_score = 0;
+        cell.ins_score = 0;
+      } // end if T(0,0)
+      else if (j == 0)
+      {
+        cell.sub_score = ADP_MINUS_INFINITY;
+        cell.del_score = (h + (i * g) );
+        cell.ins_score = ADP_MINUS_INFINITY;
+      } // end else if zeroeth column
+      else if (i == 0)
+      {
+        cell.sub_score = ADP_MINUS_INFINITY;
+        cell.del_score = ADP_MINUS_INFINITY;
+        cell.ins_score = (h + (j * g) );
+      } // end else if zeroeth row
+      else
+      {
+        bandCell (T, S2, subRow, i, j, g, h);
+      } // end else, inside the table
+
+    } // end inner loop
+
+  } // end outer loop
+
+} // end fillBand function
+
+  // bandNeeded function:
+  // a path that leaves a band of half width k has at least
+  // |N - M| + 2 (k + 1) gap columns in at least two runs, so it
+  // scores at most
+  //   best * (N + M - gaps) / 2 + 2 h + g * gaps
+  // (best = the highest substitution score; with h > 0 every gap
+  // column may be a run of its own, so h + g a column and no 2 h).
+  // Returns the smallest k where that is below "score", so nothing
+  // outside the band can beat it (N + M, the whole table, if there
+  // is no such bound).
+
+int bandNeeded (int N, int M, int high, int g, int h, int score)
+{
+  long long best = high;
+  long long diff = (N > M) ? (N - M) : (M - N);
+  long long shortSide = (N < M) ? N : M;
+  long long gapMost = (h > 0) ? (long long) h + g : g;
+  long long opens = (h > 0) ? 0 : 2 * (long long) h;
+  long long slope = best - (2 * gapMost);
+  long long top = (best * shortSide) + opens + (gapMost * diff);
+
+  if (top < score)
+  {
+    return 0;
+  } // end if any band will do
+
+  if (slope <= 0)
+  {
+    return N + M;
+  } // end if no bound, only the whole table will do
+
+  long long k = (top - score) / slope;
+
+  if (k > N + M)
+  {
+    k = N + M;
+  }
+
+  return (int) k;
+
+} // end bandNeeded function
+
+  // bandPath: hands the columns on to "path" until one is on the
+  // edge of the band, then only notes that it touched it
+
+template <class PATH>
+struct bandPath
+{
+  bandTable &T;
+  PATH &path;
+  bool touched;
+
+  void step (int state, int i, int j)
+  {
+    if (T.onEdge (i, j))
+    {
+      touched = true;
+    } // end if the path runs along the edge of the band
+
+    if (!touched)
+    {
+      path.step (state, i, j);
+    }
+  }
+};
+
+  // bandInfo: the band an alignment ended up in
+  // fits: false if the band outgrew the memory allowed
+
+struct bandInfo
+{
+  int band;
+  int width;
+  int widened;
+  bool fits;
+};
+
+  // alignBanded function:
+  // global alignment in a band of half width "band" around the
+  // diagonal, widening the band until the traceback stays off its
+  // edges and nothing outside it can score better, as a CIGAR and
+  // its counts (cigar.h)
+  // maxBytes > 0: gives up (an empty result, info->fits = false)
+  // once the band would need more memory than that
+  // info: the band it ended up in (may be NULL)
+  // returns the optimal score (also in result.score)
+
+int alignBanded (string &S1, string &S2, scoreScheme &scoring,
+                  int g, int h, int band, size_t maxBytes,
+                  alignResult &result, bandInfo *info = NULL)
+{
+  int n = S1.size () + 1;
+  int m = S2.size () + 1;
+  int globalScore = 0;
+  int widened = 0;
+  int width = 0;
+  bool touched = true;
+
+  if (band <= 0)
+  {
+    band = BAND_DEFAULT_WIDTH;
+  }
+
+  statsMark ();
+
+  while (touched)
+  {
+    if (maxBytes > 0 && bandBytes (n, m, band) > maxBytes)
+    {
+      cigarPath empty = cigarStart (S1, S2, result, 0, 0);
+
+      cigarFinish (empty, result);
+      result.score = 0;
+
+      if (info != NULL)
+      {
+        info->band = band;
+        info->width = 0;
+        info->widened = widened;
+        info->fits = false;
+      }
+
+      return 0;
+    } // end if the band got too wide for the budget
+
+    bandTable T (n, m, band);
+
+    statsLap (STATS_INIT);
+
+    scoreDispatch (scoring, [&] (auto sub)
+    {
+      fillBand (T, S1, S2, sub, g, h);
+    });
+
+    statsCells (T.cells.size ());
+    statsBytes (T.cells.size () * (sizeof (ADP_cell) + 1));
+    statsLap (STATS_FILL);
+
+      // backtrace from T(n-1,m-1), the same as runGlobal
+
+    cigarPath cigar = cigarStart (S1, S2, result, n - 1, m - 1);
+    bandPath <cigarPath> path = { T, cigar, false };
+
+    globalScore = cellMax (T.at (n - 1, m - 1));
+    tracePath (T, n - 1, m - 1, maxState (T.at (n - 1, m - 1)),
+               ALIGN_GLOBAL, path);
+    touched = path.touched;
+
+    statsLap (STATS_TRACE);
+
+    if (touched)
+    {
+      band = band * 2;
+      widened++;
+      continue;
+    } // end if widen the band and try again
+
+      // the traceback stayed inside, but a path that leaves the band
+      // could still score better: make sure the band is wide enough
+      // that no such path can beat the score we have
+
+    int needed = bandNeeded (n - 1, m - 1, scoring.high, g, h, globalScore);
+
+    if ( (needed > band) && ( (T.lo > -(n - 1)) || (T.hi < m - 1) ) )
+    {
+      band = needed;
+      widened++;
+      touched = true;
+    } // end if the band is too narrow to be sure
+    else
+    {
+      cigarFinish (cigar, result);
+      width = T.width;
+    } // end else, done
+
+  } // end while the traceback touches the band edge
+
+  result.score = globalScore;
+
+  if (info != NULL)
+  {
+    info->band = band;
+    info->width = width;
+    info->widened = widened;
+    info->fits = true;
+  }
+
+  return globalScore;
+
+} // end alignBanded function
+
+  // runGlobalBanded function:
+  // alignBanded, printed and counted like runGlobal
+  // maxBytes > 0: gives up (*fits = false, nothing printed but n / m)
+  // once the band would need more memory than that
+
+int runGlobalBanded (string S1, string S2, scoreScheme &scoring,
+                      int g, int h, int band,
+                      int *matchCount, int *mismatchCount,
+                      int *gapCount, int *openingGap,
+                      size_t maxBytes = 0, bool *fits = NULL)
+{
+  int globalScore = 0;
+  alignResult theResult;
+  bandInfo info;
+
+  cout << "n: " << S1.size () + 1 << endl;
+  cout << "m: " << S2.size () + 1 << endl;
+
+  globalScore = alignBanded (S1, S2, scoring, g, h, band, maxBytes,
+                             theResult, &info);
+
+  if (fits != NULL)
+  {
+    *fits = info.fits;
+  }
+
+  if (!info.fits)
+  {
+    cout << "band: +/- " << info.band << " needs ";
+    cout << bandBytes (S1.size () + 1, S2.size () + 1, info.band) /
+            (1024 * 1024);
+    cout << " MB, over the memory budget" << endl << endl;
+
+    return 0;
+  } // end if the band got too wide for the budget
+
+  cout << "band: +/- " << info.band << " (" << info.width;
+  cout << " cells per row, widened " << info.widened << " times)" << endl;
+
+  tallyResult (theResult, matchCount, mismatchCount, gapCount, openingGap);
+
+  printCigarAlignment (S1, S2, theResult);
+
+  return globalScore;
+
+} // end runGlobalBanded function
+
+#endif
@@ -0,0 +1,387 @@
+/*
+* Cpt_S 471
+* Programming Assignment #1
+*
+* batch.h
+*
+* Batch mode: align every query against every target (or every
+* pair of records in one file) and print one summary line per
+* pair as soon as it is done.  The pairs are dealt out to one queue
+* per worker thread; a worker takes from the back of its own queue
+* and, when that runs dry, steals from the front of another one.
+* With --lanes, global pairs go through the SIMD lanes of
+* interSeq.h instead, a chunk of pairs per worker.
+* With --screen K, a pair whose edit distance (myersEdit.h) is more
+* than K is dropped before the affine alignment.
+* With --stats-only, each pair gets only its score and counts
+* (statsOnly.h), in two rows and no backtrace, and a "*" CIGAR.
+*
+*/
+
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <string.h>
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include "alignCore.h"
+#include "pairAlign.h"
+#include "cigar.h"
+#include "interSeq.h"
+#include "myersEdit.h"
+#include "planner.h"
+#include "statsOnly.h"
+#include "../../Common/fastaMap.h"
+#include "../../Common/packedSeq.h"
+
+using namespace std;
+
+  // readFasta function:
+  // reads every record of a FASTA file (fastaMap.h), the name is the
+  // label up to the first space, the sequence is every line after it,
+  // kept at 2 bits per base (packedSeq.h) until its pairs are aligned
+  // returns the number of records (0 if the file can't be opened)
+
+int readFasta (string fileName, vector <string> &names,
+                vector <packedSeq> &seqs)
+{
+  fastaFile theFile;
+
+  if (!theFile.open (fileName))
+  {
+    return 0;
+  }
+
+  for (size_t r = 0; r < theFile.records.size (); r++)
+  {
+    names.push_back (theFile.records[r].name.str ());
+    seqs.push_back (packedSeq (theFile.records[r].seq.data,
+                               theFile.records[r].seq.length));
+  } // end for each record
+
+  return names.size ();
+
+} // end readFasta function
+
+  // batchJob: one pair to align (index into the queries / targets)
+
+struct batchJob
+{
+  int query;
+  int target;
+};
+
+  // batchQueue: one worker's jobs
+
+struct batchQueue
+{
+  deque <batchJob> jobs;
+  mutex lock;
+};
+
+  // batchTake function:
+  // the next job for worker w: its own newest job, or else
+  // the oldest job of the next worker that has any
+  // returns false when every queue is empty
+
+bool batchTake (vector <batchQueue> &queues, int w, batchJob *job)
+{
+  int count = queues.size ();
+
+  for (int k = 0; k < count; k++)
+  {
+    batchQueue &theQueue = queues[(w + k) % count];
+    unique_lock <mutex> hold (theQueue.lock);
+
+    if (theQueue.jobs.empty ())
+    {
+      continue;
+    }
+
+    if (k == 0)
+    {
+      *job = theQueue.jobs.back ();
+      theQueue.jobs.pop_back ();
+    } // end if our own queue
+    else
+    {
+      *job = theQueue.jobs.front ();
+      theQueue.jobs.pop_front ();
+    } // end else, steal
+
+    return true;
+
+  } // end for each queue
+
+  return false;
+
+} // end batchTake function
+
+  // batchScreened function:
+  // true if screen >= 0 and S1 / S2 are more than "screen" edits
+  // apart, so the pair is not worth aligning
+
+bool batchScreened (string &S1, string &S2, int screen)
+{
+  return (screen >= 0) && (myersDistance (S1, S2, screen) > screen);
+
+} // end batchScreened function
+
+  // printScreened function:
+  // the comment line saying how many pairs --screen dropped
+
+void printScreened (int screen, int screened)
+{
+  if (screen >= 0)
+  {
+    cout << "# screened out (edit distance > " << screen << "): ";
+    cout << screened << endl;
+  }
+
+} // end printScreened function
+
+  // printResultHeader / printResultLine functions:
+  // the comment line naming the columns, and the columns of one
+  // pair after its query and target names
+
+void printResultHeader ()
+{
+  cout << "# query\ttarget\tscore\tcolumns\tmatches\tmismatches";
+  cout << "\tgaps\topeningGaps\tcigar" << endl;
+
+} // end printResultHeader function
+
+void printResultLine (alignResult &theResult)
+{
+  cout << theResult.score << "\t" << theResult.columns;
+  cout << "\t" << theResult.matchCount << "\t" << theResult.mismatchCount;
+  cout << "\t" << theResult.gapCount << "\t" << theResult.openingGap;
+  cout << "\t" << cigarString (theResult) << endl;
+
+} // end printResultLine function
+
+  // runBatch function:
+  // aligns the pairs (queries x targets, or if allPairs every pair
+  // i < j of the queries) on "workers" threads, one thread per pair,
+  // global, local or semi-global (mode, alignCore.h),
+  // printing one tab separated line per pair as it finishes:
+  // query, target, score, columns, matches, mismatches, gaps, openingGaps,
+  // cigar (cigar.h)
+  // screen >= 0: pairs more than "screen" edits apart get no line
+  // budget: the memory of each worker, a pair too big for the table
+  // in that goes with checkpoints or in linear space (planner.h)
+  // statsOnly: only the score and counts, no CIGAR (statsOnly.h)
+  // returns the number of pairs
+
+int runBatch (vector <string> &qNames, vector <packedSeq> &qSeqs,
+               vector <string> &tNames, vector <packedSeq> &tSeqs,
+               bool allPairs, scoreScheme &scoring, int g, int h,
+               int mode, int workers, int screen, size_t budget,
+               bool statsOnly)
+{
+  vector <batchQueue> queues (workers > 0 ? workers : 1);
+  vector <thread> threads;
+  mutex printLock;
+  atomic <int> screened (0);
+  int pairCount = 0;
+
+  workers = queues.size ();
+
+    // deal the pairs out round robin
+
+  for (int q = 0; q < (int) qSeqs.size (); q++)
+  {
+    int tStart = allPairs ? q + 1 : 0;
+    int tEnd = allPairs ? qSeqs.size () : tSeqs.size ();
+
+    for (int t = tStart; t < tEnd; t++)
+    {
+      batchJob job;
+
+      job.query = q;
+      job.target = t;
+      queues[pairCount % workers].jobs.push_back (job);
+      pairCount++;
+    }
+  } // end for each query
+
+  vector <string> &targetNames = allPairs ? qNames : tNames;
+  vector <packedSeq> &targetSeqs = allPairs ? qSeqs : tSeqs;
+
+  printResultHeader ();
+
+  for (int w = 0; w < workers; w++)
+  {
+    threads.push_back (thread ([&, w] ()
+    {
+      batchJob job;
+      dpArena arena (true);
+
+      while (batchTake (queues, w, &job))
+      {
+        alignResult theResult;
+        string S1 = qSeqs[job.query].str ();
+        string S2 = targetSeqs[job.target].str ();
+
+        if (batchScreened (S1, S2, screen))
+        {
+          screened++;
+          continue;
+        } // end if too far apart to align
+
+        if (statsOnly)
+        {
+          alignStatsOnly (S1, S2, scoring, g, h, mode, theResult);
+        }
+        else
+        {
+          alignPlanned (S1, S2, scoring, g, h, mode, budget, arena,
+                        theResult);
+        }
+
+        unique_lock <mutex> hold (printLock);
+
+        cout << qNames[job.query] << "\t" << targetNames[job.target] << "\t";
+        printResultLine (theResult);
+
+      } // end while there are jobs
+    }));
+  } // end start the workers
+
+  for (int w = 0; w < workers; w++)
+  {
+    threads[w].join ();
+  }
+
+  printScreened (screen, screened);
+
+  return pairCount;
+
+} // end runBatch function
+
+  // BATCH_CHUNK: pairs handed to alignMany at a time in lanes mode
+
+#define BATCH_CHUNK 4096
+
+  // runBatchLanes function:
+  // runBatch for global alignment through alignMany (interSeq.h),
+  // each worker takes the next chunk of pairs and prints a line
+  // per pair when the chunk is done, in the same format
+  // screen >= 0: pairs more than "screen" edits apart get no line
+  // returns the number of pairs
+
+int runBatchLanes (vector <string> &qNames, vector <packedSeq> &qSeqs,
+                    vector <string> &tNames, vector <packedSeq> &tSeqs,
+                    bool allPairs, scoreScheme &scoring, int g, int h,
+                    int workers, int screen)
+{
+  vector <batchJob> pairs;
+  vector <thread> threads;
+  mutex printLock;
+  atomic <int> nextChunk (0);
+  atomic <int> screened (0);
+  string kernel;
+
+  for (int q = 0; q < (int) qSeqs.size (); q++)
+  {
+    int tStart = allPairs ? q + 1 : 0;
+    int tEnd = allPairs ? qSeqs.size () : tSeqs.size ();
+
+    for (int t = tStart; t < tEnd; t++)
+    {
+      batchJob job;
+
+      job.query = q;
+      job.target = t;
+      pairs.push_back (job);
+    }
+  } // end for each query
+
+  vector <string> &targetNames = allPairs ? qNames : tNames;
+  vector <packedSeq> &targetSeqs = allPairs ? qSeqs : tSeqs;
+  int chunkCount = (pairs.size () + BATCH_CHUNK - 1) / BATCH_CHUNK;
+
+  if (workers <= 0)
+  {
+    workers = 1;
+  }
+
+  printResultHeader ();
+
+  for (int w = 0; w < workers; w++)
+  {
+    threads.push_back (thread ([&] ()
+    {
+      int chunk = 0;
+      dpArena arena (true);
+
+      while ( (chunk = nextChunk++) < chunkCount)
+      {
+        int start = chunk * BATCH_CHUNK;
+        int end = start + BATCH_CHUNK;
+        vector <string> A, B;
+        vector <int> kept;
+        vector <alignResult> results;
+        string theKernel;
+
+        if (end > (int) pairs.size ())
+        {
+          end = pairs.size ();
+        }
+
+        for (int p = start; p < end; p++)
+        {
+          string S1 = qSeqs[pairs[p].query].str ();
+          string S2 = targetSeqs[pairs[p].target].str ();
+
+          if (batchScreened (S1, S2, screen))
+          {
+            screened++;
+            continue;
+          } // end if too far apart to align
+
+          A.push_back (S1);
+          B.push_back (S2);
+          kept.push_back (p);
+        }
+
+        alignMany (A, B, scoring, g, h, arena, results, &theKernel);
+
+        unique_lock <mutex> hold (printLock);
+
+        kernel = theKernel;
+
+        for (size_t k = 0; k < kept.size (); k++)
+        {
+          int p = kept[k];
+          cout << qNames[pairs[p].query] << "\t";
+          cout << targetNames[pairs[p].target] << "\t";
+          printResultLine (results[k]);
+        }
+
+      } // end while there are chunks
+    }));
+  } // end start the workers
+
+  for (int w = 0; w < workers; w++)
+  {
+    threads[w].join ();
+  }
+
+  if (kernel.length () > 0)
+  {
+    cout << "# lanes: " << kernel << endl;
+  }
+
+  printScreened (screen, screened);
+
+  return pairs.size ();
+
+} // end runBatchLanes function
+
+#endif
@@ -0,0 +1,669 @@
+/*
+* Cpt_S 471
+* Programming Assignment #1
+*
+* bench.cpp
+*
+* Benchmark for the alignment engine: times the table fill and the
+* traceback of runGlobal / runLocal separately, on the Opsin and
+* BRCA2 pairs in ../Data and on synthetic pairs (a random sequence
+* and a copy of it with about 10% substitutions and small gaps),
+* for each thread count and tile size given, and prints one tab
+* separated line per run:
+*
+*   case  mode  n  m  threads  fill_s  trace_s  cells  gcups
+*   speedup  peak_rss_kb  score  tile  l1d_misses  llc_misses
+*
+* gcups = cells / fill_s / 10^9, speedup = fill_s of the first
+* thread count / this fill_s, peak_rss_kb = the most memory the run
+* held (the high water mark is reset before each run).  tile is the
+* wavefront tile side the fill used (wavefrontTile, wavefront.h, so
+* --tiles 0 shows the cache sized side it came to), l1d_misses / llc_misses count
+* the L1 data cache read misses and last level cache misses of the
+* fill (Linux perf events, "-" if the system doesn't allow them).
+* --tiles 0,100000 compares the cache sized tiles (0) with the
+* whole table as one tile.
+* Pairs too big for the full table (more than --max-table cells)
+* only get the score-only striped local kernel ("score" mode, no
+* traceback), pairs bigger than --max-cells are skipped.
+*
+* With --compare <file> the gcups of every run are checked against
+* an earlier output; a run more than --tolerance slower is printed
+* as a REGRESSION and the exit status is 1.
+*
+* To compile:	g++ -O2 -pthread bench.cpp -o bench
+* To run:	./bench [--sizes 1000,10000,100000,1000000]
+*		[--threads 1,2,4] [--tiles 0] [--data ../Data] [--max-table CELLS]
+*		[--max-cells CELLS] [--compare <file>] [--tolerance 0.1]
+*
+*/
+
+#include <string.h>
+#include <stdlib.h>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <map>
+#include <chrono>
+#include <thread>
+#include <sys/resource.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#include "alignCore.h"
+#include "traceback.h"
+#include "wavefront.h"
+#include "stripedLocal.h"
+#include "scoring.h"
+#include "dpArena.h"
+#include "runStats.h"
+#include "../../Common/fastaMap.h"
+
+using namespace std;
+using namespace chrono;
+
+  // the values in parameters.config
+
+#define BENCH_MATCH 1
+#define BENCH_MISMATCH -1
+#define BENCH_H -3
+#define BENCH_G -1
+
+  // benchCase: one pair of sequences to run
+
+struct benchCase
+{
+  string name;
+  string S1;
+  string S2;
+};
+
+  // benchRun: the result of one run
+
+struct benchRun
+{
+  string name;
+  string mode;
+  int threads;
+  double fill;
+  double trace;
+  double cells;
+  long peakKB;
+  int score;
+  int tile;
+  long long l1Misses;
+  long long llcMisses;
+};
+
+  // missCounter: cache misses of this process and the threads it
+  // starts while counting (-1 if perf events can't be opened)
+
+struct missCounter
+{
+  int l1;
+  int llc;
+
+  missCounter ()
+  {
+    l1 = open (PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D |
+               (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+               (PERF_COUNT_HW_CACHE_RESULT_MISS << 16));
+    llc = open (PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+  }
+
+  ~missCounter ()
+  {
+    if (l1 >= 0)
+    {
+      close (l1);
+    }
+    if (llc >= 0)
+    {
+      close (llc);
+    }
+  }
+
+  static int open (unsigned int type, unsigned long long config)
+  {
+    struct perf_event_attr attr;
+
+    memset (&attr, 0, sizeof (attr));
+    attr.size = sizeof (attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = 1;
+    attr.inherit = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+
+    return syscall (__NR_perf_event_open, &attr, 0, -1, -1, 0);
+  }
+
+  void start ()
+  {
+    for (int fd : {l1, llc})
+    {
+      if (fd >= 0)
+      {
+        ioctl (fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl (fd, PERF_EVENT_IOC_ENABLE, 0);
+      }
+    }
+  }
+
+  static long long stop (int fd)
+  {
+    long long count = -1;
+
+    if (fd >= 0)
+    {
+      ioctl (fd, PERF_EVENT_IOC_DISABLE, 0);
+
+      if (read (fd, &count, sizeof (count)) != sizeof (count))
+      {
+        count = -1;
+      }
+    }
+
+    return count;
+  }
+};
+
+  // resetPeak function:
+  // starts a new high water mark for the memory (Linux, clear_refs)
+
+void resetPeak ()
+{
+  ofstream clear ("/proc/self/clear_refs");
+
+  if (clear)
+  {
+    clear << "5" << endl;
+  }
+
+} // end resetPeak function
+
+  // elapsed function:
+  // seconds since "start"
+
+double elapsed (steady_clock::time_point start)
+{
+  return duration <double> (steady_clock::now () - start).count ();
+
+} // end elapsed function
+
+  // syntheticPair function:
+  // a random sequence of "length" bases and a copy of it with about
+  // 10% substitutions and 1% insertions / deletions of 1 - 3 bases
+
+benchCase syntheticPair (int length, unsigned int seed)
+{
+  benchCase theCase;
+  const char *bases = "ACGT";
+
+  srand (seed);
+
+  theCase.name = "synthetic_" + to_string (length);
+  theCase.S1.reserve (length);
+
+  for (int k = 0; k < length; k++)
+  {
+    theCase.S1.push_back (bases[rand () % 4]);
+  }
+
+  theCase.S2.reserve (length + length / 50);
+
+  for (int k = 0; k < length; k++)
+  {
+    int roll = rand () % 1000;
+
+    if (roll < 5)
+    {
+      k += rand () % 3;
+    } // end if deletion
+    else if (roll < 10)
+    {
+      int gap = 1 + rand () % 3;
+
+      for (int e = 0; e < gap; e++)
+      {
+        theCase.S2.push_back (bases[rand () % 4]);
+      }
+
+      theCase.S2.push_back (theCase.S1[k]);
+    } // end else if insertion
+    else if (roll < 110)
+    {
+      theCase.S2.push_back (bases[(theCase.S1[k] == 'A') ? 1 + rand () % 3
+                                                         : rand () % 4]);
+    } // end else if substitution
+    else
+    {
+      theCase.S2.push_back (theCase.S1[k]);
+    }
+  } // end for each base
+
+  return theCase;
+
+} // end syntheticPair function
+
+  // fileCase function:
+  // the first two records of ../Data/<file>, false if not there
+
+bool fileCase (string dataDir, string fileName, string name,
+                benchCase *theCase)
+{
+  fastaFile inFile;
+
+  if (!inFile.open (dataDir + "/" + fileName) || inFile.records.size () < 2)
+  {
+    return false;
+  }
+
+  theCase->name = name;
+  theCase->S1 = inFile.records[0].seq.str ();
+  theCase->S2 = inFile.records[1].seq.str ();
+
+  return true;
+
+} // end fileCase function
+
+  // runFull function:
+  // the runGlobal (local = false) or runLocal fill and traceback
+  // on "threads" threads, timed separately
+
+benchRun runFull (benchCase &theCase, bool local, int threads, int tile,
+                   scoreScheme &scoring, dpArena &arena)
+{
+  missCounter misses;
+  benchRun theRun;
+  int n = theCase.S1.size () + 1;
+  int m = theCase.S2.size () + 1;
+  int highScore = 0, maxI = 0, maxJ = 0;
+  ADP_cell lastCell;
+  vector <char> theS1, theS2;
+
+  theRun.name = theCase.name;
+  theRun.mode = local ? "local" : "global";
+  theRun.threads = threads;
+  theRun.cells = (double) (n - 1) * (m - 1);
+  theRun.score = 0;
+
+  arena.release ();
+  resetPeak ();
+  wavefrontTileSize = tile;
+  theRun.tile = wavefrontTile (n, m, threads);
+
+  misses.start ();
+
+  steady_clock::time_point start = steady_clock::now ();
+
+  arena.reset ();
+  traceMatrix T (n, m, BENCH_H, arena);
+
+  bool filled = (T.bits != NULL) &&
+    scoreDispatch (scoring, [&] (auto sub)
+    {
+      return wavefrontFill (T, theCase.S1, theCase.S2, n, m, sub,
+                            BENCH_G, BENCH_H,
+                            local ? ALIGN_LOCAL : ALIGN_GLOBAL, threads,
+                            arena, &lastCell, &highScore, &maxI, &maxJ);
+    });
+
+  theRun.fill = elapsed (start);
+  theRun.l1Misses = missCounter::stop (misses.l1);
+  theRun.llcMisses = missCounter::stop (misses.llc);
+
+  if (!filled)
+  {
+    theRun.fill = -1;
+    theRun.trace = -1;
+    theRun.peakKB = peakKB ();
+    return theRun;
+  } // end if out of memory
+
+  start = steady_clock::now ();
+
+  if (local)
+  {
+    theRun.score = highScore;
+
+    if (highScore > 0)
+    {
+      traceBack (T, theCase.S1, theCase.S2, maxI, maxJ, 0,
+                 ALIGN_LOCAL, theS1, theS2);
+    }
+  } // end if local
+  else
+  {
+    theRun.score = cellMax (lastCell);
+    traceBack (T, theCase.S1, theCase.S2, n - 1, m - 1,
+               maxState (lastCell), ALIGN_GLOBAL, theS1, theS2);
+  } // end else, global
+
+  theRun.trace = elapsed (start);
+  theRun.peakKB = peakKB ();
+
+  return theRun;
+
+} // end runFull function
+
+  // runScoreOnly function:
+  // the striped local kernel, no table and no traceback
+
+benchRun runScoreOnly (benchCase &theCase, scoreScheme &scoring,
+                        string *kernel)
+{
+  benchRun theRun;
+  int endI = 0, endJ = 0;
+
+  theRun.name = theCase.name;
+  theRun.threads = 1;
+  theRun.cells = (double) theCase.S1.size () * theCase.S2.size ();
+  theRun.trace = 0;
+  theRun.tile = 0;
+  theRun.l1Misses = -1;
+  theRun.llcMisses = -1;
+
+  resetPeak ();
+
+  steady_clock::time_point start = steady_clock::now ();
+
+  theRun.score = runLocalScore (theCase.S1, theCase.S2, scoring,
+                                BENCH_G, BENCH_H, &endI, &endJ, kernel);
+  theRun.fill = elapsed (start);
+  theRun.peakKB = peakKB ();
+  theRun.mode = "score";
+
+  return theRun;
+
+} // end runScoreOnly function
+
+  // printCount function:
+  // a count, or "-" if there is none
+
+void printCount (long long count)
+{
+  if (count < 0)
+  {
+    cout << "\t-";
+  }
+  else
+  {
+    cout << "\t" << count;
+  }
+
+} // end printCount function
+
+  // printRun function:
+  // one output line, "first" is the fill time of the first thread count
+
+void printRun (benchRun &theRun, int n, int m, double first)
+{
+  cout << theRun.name << "\t" << theRun.mode << "\t" << n << "\t" << m;
+  cout << "\t" << theRun.threads;
+
+  if (theRun.fill < 0)
+  {
+    cout << "\t-\t-\t" << (long long) theRun.cells << "\t-\t-\t";
+    cout << theRun.peakKB << "\t-\t" << theRun.tile << "\t-\t-" << endl;
+    return;
+  } // end if it didn't run
+
+  cout << "\t" << fixed << setprecision (6) << theRun.fill;
+  cout << "\t" << theRun.trace;
+  cout << "\t" << setprecision (0) << theRun.cells;
+  cout << "\t" << setprecision (4) << theRun.cells / theRun.fill / 1e9;
+  cout << "\t" << setprecision (2) << ( (theRun.fill > 0) ? first / theRun.fill : 0);
+  cout << "\t" << theRun.peakKB << "\t" << theRun.score;
+  cout << "\t" << theRun.tile;
+  printCount (theRun.l1Misses);
+  printCount (theRun.llcMisses);
+  cout << endl;
+  cout.unsetf (ios::floatfield);
+
+} // end printRun function
+
+  // splitList function:
+  // "1,2,4" -> 1 2 4
+
+vector <long long> splitList (string theList)
+{
+  vector <long long> values;
+  stringstream words (theList);
+  string word;
+
+  while (getline (words, word, ','))
+  {
+    if (word.length () > 0)
+    {
+      values.push_back (atoll (word.c_str ()));
+    }
+  }
+
+  return values;
+
+} // end splitList function
+
+  // readBaseline function:
+  // gcups of every run (case, mode, threads) in an earlier output
+
+map <string, double> readBaseline (string fileName)
+{
+  map <string, double> gcups;
+  ifstream inFile (fileName);
+  string theLine;
+
+  while (getline (inFile, theLine))
+  {
+    vector <string> fields;
+    stringstream words (theLine);
+    string word;
+
+    if (theLine.length () == 0 || theLine[0] == '#')
+    {
+      continue;
+    }
+
+    while (getline (words, word, '\t'))
+    {
+      fields.push_back (word);
+    }
+
+    if (fields.size () >= 9 && fields[8] != "-")
+    {
+      string key = fields[0] + "/" + fields[1] + "/" + fields[4];
+
+      if (fields.size () >= 13)
+      {
+        key += "/" + fields[12];
+      } // end if it has a tile size
+
+      gcups[key] = atof (fields[8].c_str ());
+    }
+  } // end while loop through the file
+
+  return gcups;
+
+} // end readBaseline function
+
+int main (int argc, char * argv [])
+{
+  vector <long long> sizes = {1000, 10000, 100000, 1000000};
+  vector <long long> threadCounts;
+  vector <long long> tiles = {0};
+  string dataDir = "../Data";
+  string compareFile;
+  double tolerance = 0.1;
+  double maxTable = 4e9;
+  double maxCells = 2e11;
+  int hardware = thread::hardware_concurrency ();
+  int regressions = 0;
+  scoreScheme scoring;
+  dpArena arena (true);
+
+  for (int t = 1; t < hardware; t *= 2)
+  {
+    threadCounts.push_back (t);
+  }
+
+  threadCounts.push_back ( (hardware > 0) ? hardware : 1);
+
+  for (int a = 1; a < argc; a++)
+  {
+    string theArg = argv[a];
+
+    if (theArg == "--sizes" && a + 1 < argc)
+    {
+      sizes = splitList (argv[++a]);
+    }
+    else if (theArg == "--threads" && a + 1 < argc)
+    {
+      threadCounts = splitList (argv[++a]);
+    }
+    else if (theArg == "--tiles" && a + 1 < argc)
+    {
+      tiles = splitList (argv[++a]);
+    }
+    else if (theArg == "--data" && a + 1 < argc)
+    {
+      dataDir = argv[++a];
+    }
+    else if (theArg == "--max-table" && a + 1 < argc)
+    {
+      maxTable = atof (argv[++a]);
+    }
+    else if (theArg == "--max-cells" && a + 1 < argc)
+    {
+      maxCells = atof (argv[++a]);
+    }
+    else if (theArg == "--compare" && a + 1 < argc)
+    {
+      compareFile = argv[++a];
+    }
+    else if (theArg == "--tolerance" && a + 1 < argc)
+    {
+      tolerance = atof (argv[++a]);
+    }
+    else
+    {
+      cout << "Unknown option " << theArg << " - ignoring" << endl;
+    }
+  } // end loop through arguments
+
+  setScoring (&scoring, "", BENCH_MATCH, BENCH_MISMATCH);
+
+  vector <benchCase> cases;
+  benchCase theCase;
+
+  if (fileCase (dataDir, "Opsin1_colorblindness_gene.fasta.txt", "opsin",
+                &theCase))
+  {
+    cases.push_back (theCase);
+  }
+
+  if (fileCase (dataDir, "Human-Mouse-BRCA2-cds.fasta.txt", "brca2",
+                &theCase))
+  {
+    cases.push_back (theCase);
+  }
+
+  for (size_t s = 0; s < sizes.size (); s++)
+  {
+    cases.push_back (syntheticPair (sizes[s], 471 + s));
+  }
+
+  map <string, double> baseline;
+
+  if (compareFile.length () > 0)
+  {
+    baseline = readBaseline (compareFile);
+  }
+
+  cout << "# threads available: " << hardware << endl;
+  cout << "# cache sized tile: " << wavefrontCacheTile () << endl;
+  cout << "# case\tmode\tn\tm\tthreads\tfill_s\ttrace_s\tcells\tgcups";
+  cout << "\tspeedup\tpeak_rss_kb\tscore\ttile\tl1d_misses\tllc_misses";
+  cout << endl;
+
+  for (size_t c = 0; c < cases.size (); c++)
+  {
+    benchCase &thisCase = cases[c];
+    int n = thisCase.S1.size ();
+    int m = thisCase.S2.size ();
+    double cells = (double) n * m;
+    vector <benchRun> runs;
+
+    if (cells > maxCells)
+    {
+      cout << "# " << thisCase.name << ": " << cells;
+      cout << " cells, over --max-cells, skipped" << endl;
+      continue;
+    } // end if too big to run at all
+
+    if (cells <= maxTable)
+    {
+      for (int local = 0; local < 2; local++)
+      {
+        for (size_t k = 0; k < tiles.size (); k++)
+        {
+          double first = 0;
+
+          for (size_t t = 0; t < threadCounts.size (); t++)
+          {
+            benchRun theRun = runFull (thisCase, local == 1, threadCounts[t],
+                                       tiles[k], scoring, arena);
+
+            if (t == 0)
+            {
+              first = theRun.fill;
+            }
+
+            printRun (theRun, n, m, first);
+            runs.push_back (theRun);
+          } // end for each thread count
+        } // end for each tile size
+      } // end for global, then local
+    } // end if the table fits
+    else
+    {
+      cout << "# " << thisCase.name << ": table over --max-table, ";
+      cout << "score only" << endl;
+    } // end else, too big for the table
+
+    string kernel;
+    benchRun theRun = runScoreOnly (thisCase, scoring, &kernel);
+
+    cout << "# " << thisCase.name << " score kernel: " << kernel << endl;
+    printRun (theRun, n, m, theRun.fill);
+    runs.push_back (theRun);
+
+    arena.release ();
+
+      // check against the earlier output
+
+    for (size_t r = 0; r < runs.size () && !baseline.empty (); r++)
+    {
+      string key = runs[r].name + "/" + runs[r].mode + "/" +
+                   to_string (runs[r].threads) + "/" +
+                   to_string (runs[r].tile);
+
+      if (baseline.count (key) && runs[r].fill > 0)
+      {
+        double gcups = runs[r].cells / runs[r].fill / 1e9;
+
+        if (gcups < baseline[key] * (1 - tolerance))
+        {
+          cout << "# REGRESSION " << key << ": " << fixed << setprecision (4) << gcups;
+          cout << " gcups, was " << baseline[key] << endl;
+          regressions++;
+        }
+      }
+    } // end for each run
+
+  } // end for each case
+
+  return (regressions > 0) ? 1 : 0;
+
+} // end main function
@@ -0,0 +1,517 @@
+/*
+* Cpt_S 471
+* Programming Assignment #1
+*
+* check.cpp
+*
+* Cross checks the ways of aligning a pair against each other and
+* against a plain table of all three scores of every cell, filled
+* with the recurrence of the original runGlobal (refScore).  Random
+* pairs (up to --length long, every 20th up to 8 times that so
+* linear space splits them; some of them copies of each other with
+* a few changes) go through global, local and semi-global with each
+* set of scores in checkScores, among them positive h (a gap opening
+* bonus) and h + g > 0, where a gap can pay for itself.
+*
+* For every pair and mode:
+*
+*   full table	alignPair on 1 and 3 threads: the score of refScore,
+*		and the counts of the alignment add up to the score
+*		(match * matches + mismatch * mismatches + h * opening
+*		gaps + g * gaps)
+*   checkpoint	alignCheckpoint: the same alignment as alignPair
+*   linear	alignLinear (global): the same alignment, and
+*		globalScoreLinear the same score
+*   band	alignBanded (global) from a band of 1 and of 8, widened
+*		as it needs: the same alignment
+*   planned	alignPlanned with a budget of 1 byte, 4 kB and 1 GB
+*		(linear space or checkpoints, the band, the table):
+*		the same alignment
+*   stats only	alignStatsOnly: the same score, counts, start and end
+*   top		topLocal (local): the best hit has the local score
+*   score only	runLocalScore (local, the striped kernel for h <= 0)
+*		and localScoreScalar: the score and end of the table
+*
+* and all the pairs of a set of scores at once:
+*
+*   lanes	alignMany (global, a pair to a SIMD lane), with the
+*		scores and with the transition matrix (a query
+*		profile): the same alignment as alignPair
+*
+* Every disagreement is printed, with the pair, and the exit status
+* is 1 if there was one.
+*
+* To compile:	g++ -O2 -pthread check.cpp -o check
+* To run:	./check [--pairs 300] [--length 80] [--seed 471]
+*
+*/
+
+#include <string.h>
+#include <stdlib.h>
+#include <iostream>
+#include <vector>
+#include "alignCore.h"
+#include "cigar.h"
+#include "pairAlign.h"
+#include "checkpoint.h"
+#include "statsOnly.h"
+#include "linearSpace.h"
+#include "stripedLocal.h"
+#include "banded.h"
+#include "planner.h"
+#include "topLocal.h"
+#include "interSeq.h"
+#include "scoring.h"
+#include "dpArena.h"
+
+using namespace std;
+
+  // checkParams: one set of scores to run every pair with
+
+struct checkParams
+{
+  int match;
+  int mismatch;
+  int h;
+  int g;
+};
+
+  // parameters.config, a positive h, and h + g > 0
+
+checkParams checkScores[] =
+{
+  { 1, -1, -3, -1 },
+  { 1, -2, 2, -2 },
+  { 2, -3, 5, -1 },
+  { 1, -1, 3, -1 }
+};
+
+#define CHECK_SCORES (int) (sizeof (checkScores) / sizeof (checkParams))
+
+const char *checkModes[] = { "global", "local", "semi-global" };
+
+int failures = 0;
+
+  // refScore function:
+  // the optimal score from a table of all three scores of every
+  // cell, as the original runGlobal filled it: a deletion extends
+  // the one above or opens after its substitution or insertion, an
+  // insertion extends the one to the left or opens after its
+  // substitution or deletion
+  // local: nothing below 0, the score is the highest substitution
+  // semi-global: a free zeroeth row, the best cell of the last row
+
+int refScore (string &S1, string &S2, checkParams &p, int mode)
+{
+  int n = S1.size () + 1;
+  int m = S2.size () + 1;
+  int best = 0;
+  bool local = (mode == ALIGN_LOCAL);
+  vector < vector <ADP_cell> > T (n, vector <ADP_cell> (m));
+
+  for (int i = 0; i < n; i++)
+  {
+    for (int j = 0; j < m; j++)
+    {
+      ADP_cell &cell = T[i][j];
+
+      cell.sub_score = 0;
+      cell.del_score = 0;
+      cell.ins_score = 0;
+
+      if (local || (i == 0 && j == 0) )
+      {
+        if (i == 0 || j == 0)
+        {
+          continue;
+        }
+      } // end if local or T(0,0), the edges are all 0
+      else if (i == 0 && mode == ALIGN_SEMIGLOBAL)
+      {
+        cell.del_score = ADP_MINUS_INFINITY;
+        cell.ins_score = ADP_MINUS_INFINITY;
+        continue;
+      } // end if semi-global's free zeroeth row
+      else if (i == 0 || j == 0)
+      {
+        cell.sub_score = ADP_MINUS_INFINITY;
+        cell.del_score = (j == 0) ? p.h + i * p.g : ADP_MINUS_INFINITY;
+        cell.ins_score = (i == 0) ? p.h + j * p.g : ADP_MINUS_INFINITY;
+        continue;
+      } // end if the zeroeth row or column
+
+      ADP_cell &diag = T[i-1][j-1];
+      ADP_cell &up = T[i-1][j];
+      ADP_cell &left = T[i][j-1];
+
+      cell.sub_score = cellMax (diag) +
+                       ( (S1[i-1] == S2[j-1]) ? p.match : p.mismatch);
+      cell.del_score = max (up.del_score + p.g,
+                            max (up.sub_score, up.ins_score) + p.h + p.g);
+      cell.ins_score = max (left.ins_score + p.g,
+                            max (left.sub_score, left.del_score) + p.h + p.g);
+
+      if (local)
+      {
+        cell.sub_score = max (cell.sub_score, 0);
+        cell.del_score = max (cell.del_score, 0);
+        cell.ins_score = max (cell.ins_score, 0);
+        best = max (best, cell.sub_score);
+      } // end if local, nothing below 0
+    }
+  } // end fill the table
+
+  if (local)
+  {
+    return best;
+  }
+
+  if (mode == ALIGN_SEMIGLOBAL)
+  {
+    best = cellMax (T[n-1][0]);
+
+    for (int j = 1; j < m; j++)
+    {
+      best = max (best, cellMax (T[n-1][j]));
+    }
+
+    return best;
+  } // end if semi-global, the best of the last row
+
+  return cellMax (T[n-1][m-1]);
+
+} // end refScore function
+
+  // randomPair function:
+  // two random sequences, or (every other pair) the second a copy
+  // of the first with about one change in eight
+
+void randomPair (int length, string *S1, string *S2)
+{
+  const char *bases = "ACGTN";
+  int n = rand () % (length + 1);
+
+  S1->clear ();
+  S2->clear ();
+
+  for (int k = 0; k < n; k++)
+  {
+    S1->push_back (bases[ (rand () % 20 == 0) ? 4 : rand () % 4]);
+  }
+
+  if (rand () % 2)
+  {
+    int m = rand () % (length + 1);
+
+    for (int k = 0; k < m; k++)
+    {
+      S2->push_back (bases[rand () % 4]);
+    }
+
+    return;
+  } // end if unrelated
+
+  for (int k = 0; k < n; k++)
+  {
+    int roll = rand () % 24;
+
+    if (roll == 0)
+    {
+      continue;
+    } // end if deletion
+    else if (roll == 1)
+    {
+      S2->push_back (bases[rand () % 4]);
+    } // end else if insertion
+    else if (roll == 2)
+    {
+      S2->push_back (bases[rand () % 4]);
+      continue;
+    } // end else if substitution
+
+    S2->push_back ( (*S1)[k]);
+  } // end for each base
+
+} // end randomPair function
+
+  // report function:
+  // prints one disagreement, with the pair and the scores
+
+void report (string what, string &S1, string &S2, checkParams &p, int mode,
+              int expected, int got)
+{
+  failures++;
+
+  cout << "FAIL " << what << " " << checkModes[mode];
+  cout << " (match " << p.match << ", mismatch " << p.mismatch;
+  cout << ", h " << p.h << ", g " << p.g << "): expected " << expected;
+  cout << ", got " << got << endl;
+  cout << "  S1 = " << S1 << endl;
+  cout << "  S2 = " << S2 << endl;
+
+} // end report function
+
+  // countScore function:
+  // what the counts of an alignment add up to
+
+int countScore (alignResult &result, checkParams &p)
+{
+  return p.match * result.matchCount + p.mismatch * result.mismatchCount +
+         p.h * result.openingGap + p.g * result.gapCount;
+
+} // end countScore function
+
+  // sameAlignment function:
+  // true if two results are the same alignment
+
+bool sameAlignment (alignResult &a, alignResult &b)
+{
+  return a.score == b.score && a.cigar == b.cigar &&
+         a.startI == b.startI && a.startJ == b.startJ &&
+         a.endI == b.endI && a.endJ == b.endJ;
+
+} // end sameAlignment function
+
+  // checkPair function:
+  // every way of aligning S1 and S2 in "mode" against refScore
+  // and alignPair
+
+void checkPair (string &S1, string &S2, checkParams &p, int mode,
+                 scoreScheme &scoring, dpArena &arena)
+{
+  int expected = refScore (S1, S2, p, mode);
+  alignResult table, other;
+
+    // the full table, one thread and several
+
+  alignPair (S1, S2, scoring, p.g, p.h, mode, 1, &arena, table);
+
+  if (table.score != expected)
+  {
+    report ("full table score", S1, S2, p, mode, expected, table.score);
+  }
+  if (countScore (table, p) != table.score)
+  {
+    report ("full table counts", S1, S2, p, mode, table.score,
+            countScore (table, p));
+  }
+
+  alignPair (S1, S2, scoring, p.g, p.h, mode, 3, &arena, other);
+
+  if (!sameAlignment (table, other))
+  {
+    report ("3 threads", S1, S2, p, mode, table.score, other.score);
+  }
+
+    // the checkpoint rows, a small band to fill some of them again
+
+  alignCheckpoint (S1, S2, scoring, p.g, p.h, mode, 3, arena, other);
+
+  if (!sameAlignment (table, other))
+  {
+    report ("checkpoint", S1, S2, p, mode, table.score, other.score);
+  }
+
+    // linear space, split at the middle row down to small tables
+
+  if (mode == ALIGN_GLOBAL)
+  {
+    alignLinear (S1, S2, scoring, p.g, p.h, other);
+
+    if (!sameAlignment (table, other))
+    {
+      report ("linear", S1, S2, p, mode, table.score, other.score);
+    }
+
+    int score = globalScoreLinear (S1, S2, scoring, p.g, p.h);
+
+    if (score != table.score)
+    {
+      report ("linear score", S1, S2, p, mode, table.score, score);
+    }
+  } // end if global
+
+    // the band, widened from too narrow
+
+  for (int band = 1; mode == ALIGN_GLOBAL && band <= 8; band += 7)
+  {
+    alignBanded (S1, S2, scoring, p.g, p.h, band, 0, other);
+
+    if (!sameAlignment (table, other))
+    {
+      report ("band " + to_string (band), S1, S2, p, mode, table.score,
+              other.score);
+    }
+  } // end for each band
+
+    // whatever the planner picks for the budget
+
+  size_t budgets[] = { 1, 4096, (size_t) 1 << 30 };
+
+  for (int b = 0; b < 3; b++)
+  {
+    alignPlanned (S1, S2, scoring, p.g, p.h, mode, budgets[b], arena, other);
+
+    if (!sameAlignment (table, other))
+    {
+      report ("planned in " + to_string (budgets[b]) + " bytes", S1, S2, p,
+              mode, table.score, other.score);
+    }
+  } // end for each budget
+
+    // the counts carried forward, no table
+
+  alignStatsOnly (S1, S2, scoring, p.g, p.h, mode, other);
+
+  if (other.score != table.score ||
+      other.matchCount != table.matchCount ||
+      other.mismatchCount != table.mismatchCount ||
+      other.gapCount != table.gapCount ||
+      other.openingGap != table.openingGap ||
+      other.startI != table.startI || other.startJ != table.startJ ||
+      other.endI != table.endI || other.endJ != table.endJ)
+  {
+    report ("stats only", S1, S2, p, mode, table.score, other.score);
+  }
+
+    // the local score only, striped and scalar
+
+  if (mode == ALIGN_LOCAL)
+  {
+    int endI = 0, endJ = 0;
+    string kernel;
+    int score = runLocalScore (S1, S2, scoring, p.g, p.h, &endI, &endJ,
+                               &kernel);
+
+    if (score != table.score || endI != table.endI || endJ != table.endJ)
+    {
+      report ("score only (" + kernel + ")", S1, S2, p, mode, table.score,
+              score);
+    }
+
+    score = localScoreScalar (S1, S2, scoring, p.g, p.h, &endI, &endJ);
+
+    if (score != table.score || endI != table.endI || endJ != table.endJ)
+    {
+      report ("score only (scalar)", S1, S2, p, mode, table.score, score);
+    }
+  } // end if local
+
+    // the best of the top local alignments
+
+  if (mode == ALIGN_LOCAL && table.score > 0)
+  {
+    vector <localHit> hits;
+
+    topLocal (S1, S2, scoring, p.g, p.h, 1, arena, hits);
+
+    if (hits.size () != 1 || hits[0].score != table.score)
+    {
+      report ("top", S1, S2, p, mode, table.score,
+              hits.empty () ? 0 : hits[0].score);
+    }
+  } // end if local with a hit
+
+} // end checkPair function
+
+  // checkLanes function:
+  // the pairs A[k] / B[k] through alignMany (global, a pair to a
+  // lane), once with "scoring" and once with the transition matrix
+  // (the query profile): the same alignment as alignPair
+
+void checkLanes (vector <string> &A, vector <string> &B, checkParams &p,
+                  scoreScheme &scoring, dpArena &arena)
+{
+  scoreScheme transition;
+  scoreScheme *schemes[] = { &scoring, &transition };
+
+  setScoring (&transition, "transition", p.match, p.mismatch);
+
+  for (int s = 0; s < 2; s++)
+  {
+    vector <alignResult> results;
+    string kernel;
+
+    alignMany (A, B, *schemes[s], p.g, p.h, arena, results, &kernel);
+
+    for (int k = 0; k < (int) A.size (); k++)
+    {
+      alignResult table;
+
+      alignPair (A[k], B[k], *schemes[s], p.g, p.h, ALIGN_GLOBAL, 1, &arena,
+                 table);
+
+      if (!sameAlignment (table, results[k]) )
+      {
+        report ("lanes (" + kernel + ")", A[k], B[k], p, ALIGN_GLOBAL,
+                table.score, results[k].score);
+      }
+    } // end for each pair
+  } // end for each scoring
+
+} // end checkLanes function
+
+int main (int argc, char * argv [])
+{
+  int pairs = 300;
+  int length = 80;
+  unsigned int seed = 471;
+  dpArena arena (true);
+
+  for (int a = 1; a < argc; a++)
+  {
+    string theArg = argv[a];
+
+    if (theArg == "--pairs" && a + 1 < argc)
+    {
+      pairs = atoi (argv[++a]);
+    }
+    else if (theArg == "--length" && a + 1 < argc)
+    {
+      length = atoi (argv[++a]);
+    }
+    else if (theArg == "--seed" && a + 1 < argc)
+    {
+      seed = atoi (argv[++a]);
+    }
+    else
+    {
+      cout << "Unknown option " << theArg << " - ignoring" << endl;
+    }
+  } // end loop through arguments
+
+  srand (seed);
+
+  for (int s = 0; s < CHECK_SCORES; s++)
+  {
+    checkParams &p = checkScores[s];
+    scoreScheme scoring;
+
+    vector <string> A, B;
+
+    setScoring (&scoring, "", p.match, p.mismatch);
+
+    for (int k = 0; k < pairs; k++)
+    {
+      string S1, S2;
+
+      randomPair ( (k % 20 == 19) ? 8 * length : length, &S1, &S2);
+
+      for (int mode = ALIGN_GLOBAL; mode <= ALIGN_SEMIGLOBAL; mode++)
+      {
+        checkPair (S1, S2, p, mode, scoring, arena);
+      }
+
+      A.push_back (S1);
+      B.push_back (S2);
+    } // end for each pair
+
+    checkLanes (A, B, p, scoring, arena);
+  } // end for each set of scores
+
+  cout << pairs * CHECK_SCORES * 3 << " alignments checked, ";
+  cout << failures << " failed" << endl;
+
+  return (failures > 0) ? 1 : 0;
+
+} // end main
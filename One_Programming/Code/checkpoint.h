@@ -0,0 +1,345 @@
+/*
+* Cpt_S 471
+* Programming Assignment #1
+*
+* checkpoint.h
+*
+* Traceback from checkpoint rows, between the full table (4 bits a
+* cell) and linear space (linearSpace.h).  The forward pass cuts the
+* rows into bands of k and keeps only the scores of the row above
+* each band; the codes of a band are thrown away as soon as the band
+* is done.  The backtrace, running up the table, fills each band
+* again from its checkpoint row when it first reads a code in it,
+* so every band is filled twice: about twice the time of the full
+* table, and memory of
+*
+*   (n / k) checkpoint rows * m * 12 bytes + k * m / 2 bytes of codes
+*
+* which is smallest for k = sqrt (24 n).  For n = 10^5 that is about
+* 1.5 kB a column of S2 where the full table takes 50 kB; the table
+* grows with n, this with sqrt (n).
+*
+* Every band is filled with fillBlock (wavefront.h) in tiles across
+* the band, so the codes, the score and the alignment are the same
+* as runGlobal / runLocal / runSemiGlobal.  One thread.  The
+* bands filled again count in the fill time and the cells of the
+* stats (runStats.h), the traceback time is only the walk.
+*
+*/
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <string.h>
+#include <math.h>
+#include <iostream>
+#include <vector>
+#include "alignCore.h"
+#include "traceback.h"
+#include "cigar.h"
+#include "wavefront.h"
+#include "dpArena.h"
+#include "scoring.h"
+#include "runStats.h"
+
+using namespace std;
+
+  // checkpointRows function:
+  // the band height that needs the least memory for n rows
+
+int checkpointRows (int n)
+{
+  int k = (int) sqrt (24.0 * n);
+
+  return (k < 1) ? 1 : k;
+
+} // end checkpointRows function
+
+  // checkpointBytes function:
+  // memory of the checkpoint rows, one band of codes and S2's codes
+
+size_t checkpointBytes (int n, int m, int k, int h)
+{
+  size_t bands = (n > 1) ? (n - 1 + k - 1) / k : 0;
+
+  return bands * m * sizeof (ADP_cell) + (size_t) k * traceRowBytes (m, h) +
+         2 * (size_t) m * sizeof (ADP_cell) + m;
+
+} // end checkpointBytes function
+
+  // checkpointTable: the checkpoint rows and the codes of one band,
+  // the band is filled again when tracePath reads a row outside it
+
+template <class SCORER>
+struct checkpointTable
+{
+  string &S1;
+  unsigned char *code2;
+  const SCORER &sub;
+  int n, m, k, g, h, mode;
+  int bands;
+  ADP_cell *checkpoints;
+  ADP_cell *lastRow;
+  vector <ADP_cell> side;
+  traceMatrix T;
+  int bandStart, bandRows;
+
+  checkpointTable (string &theS1, unsigned char *theCode2,
+                   const SCORER &theSub, int theN, int theM, int theK,
+                   int theG, int theH, int theMode, dpArena &arena)
+    : S1 (theS1), sub (theSub), T (theK + 1, theM, theH, arena)
+  {
+    code2 = theCode2;
+    n = theN;
+    m = theM;
+    k = theK;
+    g = theG;
+    h = theH;
+    mode = theMode;
+    bands = (n > 1) ? (n - 1 + k - 1) / k : 0;
+    checkpoints = (ADP_cell *) arena.take (
+                    (size_t) (bands + 1) * m * sizeof (ADP_cell));
+    lastRow = (ADP_cell *) arena.take ( (size_t) m * sizeof (ADP_cell));
+    side.resize (k);
+    bandStart = 0;
+    bandRows = 0;
+  }
+
+  bool ok ()
+  {
+    return checkpoints != NULL && lastRow != NULL &&
+           (T.bits != NULL || n <= 1 || m <= 1);
+  }
+
+    // fillBand: the codes of band b (rows b * k + 1 on) into T,
+    // its last row into "below", in tiles of the cache size
+    // local: highScore / maxI / maxJ get the first cell, row by row,
+    // with the highest substitution score in the band
+
+  void fillBand (int b, ADP_cell *below,
+                 int *highScore, int *maxI, int *maxJ)
+  {
+    int rowStart = b * k + 1;
+    int rowEnd = (rowStart + k < n) ? rowStart + k : n;
+    int tile = (wavefrontTileSize > 0) ? wavefrontTileSize
+                                       : wavefrontCacheTile ();
+    string band = S1.substr (rowStart - 1, rowEnd - rowStart);
+    ADP_cell *top = &checkpoints[ (size_t) b * m];
+
+    bandStart = rowStart;
+    bandRows = rowEnd - rowStart;
+    statsCells ( (long long) bandRows * (m - 1));
+
+    for (int i = rowStart; i < rowEnd; i++)
+    {
+      side[i - rowStart] = edgeCell (i, 0, g, h, mode);
+    }
+
+    tile = tile + (tile & 1);
+
+    for (int colStart = 1; colStart < m; colStart += tile)
+    {
+      int colEnd = (colStart + tile < m) ? colStart + tile : m;
+      int tileScore = 0, tileI = 0, tileJ = 0;
+
+        // side carries the last column of each tile to the next
+
+      fillBlock (T, band, code2, 1, bandRows + 1, colStart, colEnd,
+                 &top[colStart - 1], &below[colStart - 1], &side[0],
+                 sub, g, h, (mode == ALIGN_LOCAL),
+                 &tileScore, &tileI, &tileJ);
+
+      tileI += rowStart - 1;
+
+      if ( (tileScore > *highScore) ||
+           ( (tileScore == *highScore) && (tileScore > 0) &&
+             ( (tileI < *maxI) ||
+               ( (tileI == *maxI) && (tileJ < *maxJ) ) ) ) )
+      {
+        *highScore = tileScore;
+        *maxI = tileI;
+        *maxJ = tileJ;
+      } // end if a better (or earlier) high score
+    } // end for each tile across the band
+
+    below[0] = edgeCell (rowEnd - 1, 0, g, h, mode);
+  }
+
+    // get: the code of T(i,j), the same as traceMatrix::get
+
+  int get (int i, int j)
+  {
+    if (i <= 0 || j <= 0)
+    {
+      return TRACE_ZERO;
+    }
+
+    if (i < bandStart || i >= bandStart + bandRows)
+    {
+      int highScore = 0, maxI = 0, maxJ = 0;
+
+      statsLap (STATS_TRACE);
+      fillBand ( (i - 1) / k, lastRow, &highScore, &maxI, &maxJ);
+      statsLap (STATS_FILL);
+    } // end if not in the band we have, fill it again
+
+    return T.get (i - bandStart + 1, j);
+  }
+};
+
+  // checkpointFill function:
+  // the forward pass (checkpoint rows only) and the backtrace,
+  // filling the bands again as it goes up
+  // returns the optimal score
+
+template <class SCORER>
+int checkpointFill (checkpointTable <SCORER> &C, string &S1, string &S2,
+                     alignResult &result)
+{
+  int n = C.n;
+  int m = C.m;
+  int highScore = 0, maxI = 0, maxJ = 0;
+  int score = 0;
+  ADP_cell lastCell = edgeCell (n - 1, m - 1, C.g, C.h, C.mode);
+
+  for (int j = 0; j < m; j++)
+  {
+    C.checkpoints[j] = edgeCell (0, j, C.g, C.h, C.mode);
+    C.lastRow[j] = C.checkpoints[j];
+  }
+
+  for (int b = 0; b < C.bands && m > 1; b++)
+  {
+    ADP_cell *below = (b + 1 < C.bands) ? &C.checkpoints[ (size_t) (b + 1) * m]
+                                         : C.lastRow;
+
+    C.fillBand (b, below, &highScore, &maxI, &maxJ);
+  } // end forward pass, keeping the row above each band
+
+  statsLap (STATS_FILL);
+
+  if (m <= 1)
+  {
+    for (int j = 0; j < m; j++)
+    {
+      C.lastRow[j] = edgeCell (n - 1, j, C.g, C.h, C.mode);
+    }
+  } // end if no columns to fill, the last row is all edge
+
+  if (C.mode == ALIGN_LOCAL)
+  {
+    score = highScore;
+
+    if (highScore <= 0)
+    {
+      maxI = 0;
+      maxJ = 0;
+    } // end if nothing above 0, an empty alignment
+
+    cigarPath path = cigarStart (S1, S2, result, maxI, maxJ);
+
+    tracePath (C, maxI, maxJ, 0, ALIGN_LOCAL, path);
+    cigarFinish (path, result);
+  } // end if local
+  else
+  {
+    maxI = n - 1;
+    maxJ = m - 1;
+    lastCell = C.lastRow[m - 1];
+
+    if (C.mode == ALIGN_SEMIGLOBAL)
+    {
+      for (int j = 0; j < m; j++)
+      {
+        if (j == 0 || cellMax (C.lastRow[j]) > cellMax (lastCell))
+        {
+          lastCell = C.lastRow[j];
+          maxJ = j;
+        }
+      }
+    } // end if semi-global, the best end in S2
+
+    score = cellMax (lastCell);
+
+    cigarPath path = cigarStart (S1, S2, result, maxI, maxJ);
+
+    tracePath (C, maxI, maxJ, maxState (lastCell), C.mode, path);
+    cigarFinish (path, result);
+  } // end else, global or semi-global
+
+  result.score = score;
+
+  statsLap (STATS_TRACE);
+
+  return score;
+
+} // end checkpointFill function
+
+  // alignCheckpoint function:
+  // alignPair (the CIGAR one) with the checkpointed backtrace,
+  // k rows to a band (0 = checkpointRows), the memory comes from "arena"
+  // returns the optimal score
+
+int alignCheckpoint (string &S1, string &S2, scoreScheme &scoring,
+                      int g, int h, int mode, int k, dpArena &arena,
+                      alignResult &result)
+{
+  int n = S1.size () + 1;
+  int m = S2.size () + 1;
+
+  if (k <= 0)
+  {
+    k = checkpointRows (n);
+  }
+
+  statsMark ();
+  arena.reserve (checkpointBytes (n, m, k, h));
+
+  cigarPath empty = cigarStart (S1, S2, result, 0, 0);
+
+  cigarFinish (empty, result);
+  result.score = 0;
+
+  if (mode == ALIGN_SEMIGLOBAL && n <= 1)
+  {
+    return 0;
+  } // end if an empty read, the empty alignment
+
+  unsigned char *code2 = (unsigned char *) arena.take (m);
+
+  if (code2 == NULL)
+  {
+    cout << "Not enough memory for the checkpoints - try --linear-space";
+    cout << endl;
+    return 0;
+  } // end if out of memory
+
+  for (int j = 0; j < m - 1; j++)
+  {
+    code2[j] = scoreCode (S2[j]);
+  }
+
+  int score = scoreDispatch (scoring, [&] (auto sub)
+  {
+    checkpointTable <decltype (sub)> C (S1, code2, sub, n, m, k, g, h,
+                                        mode, arena);
+
+    if (!C.ok ())
+    {
+      cout << "Not enough memory for the checkpoints - try --linear-space";
+      cout << endl;
+      return 0;
+    } // end if out of memory
+
+    statsLap (STATS_INIT);
+
+    return checkpointFill (C, S1, S2, result);
+  });
+
+  statsBytes (arena.peak);
+
+  return score;
+
+} // end alignCheckpoint function
+
+#endif
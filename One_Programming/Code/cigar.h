@@ -0,0 +1,264 @@
+/*
+* Cpt_S 471
+* Programming Assignment #1
+*
+* cigar.h
+*
+* A finished alignment as a run length CIGAR (as in SAM, S1 is the
+* query and S2 the reference) with its counts, instead of the two
+* aligned sequences a character at a time:
+*
+*   =  S1[i] against the same character of S2
+*   X  S1[i] against a different one
+*   I  S1[i] against a gap (a deletion in traceback.h terms)
+*   D  a gap against S2[j] (an insertion in traceback.h terms)
+*
+* Each run is one 32 bit word, length << 4 | op, so the backtrace
+* only adds to the last word for every column after the first of a
+* run.  The counts come from the runs: every I or D run is one
+* opening gap, the same as tallyAlignment.
+*
+* printCigarAlignment prints it in the same rows of 60 as
+* printAlignment (alignCore.h) straight from S1 and S2, a row at a
+* time; nothing else needs the characters, so the batch driver never
+* builds them.
+*
+*/
+
+#ifndef CIGAR_H
+#define CIGAR_H
+
+#include <stdint.h>
+#include <string.h>
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <algorithm>
+#include "alignCore.h"
+
+using namespace std;
+
+#define CIGAR_MATCH 0
+#define CIGAR_MISMATCH 1
+#define CIGAR_INS 2
+#define CIGAR_DEL 3
+
+#define CIGAR_OPS "=XID"
+
+  // alignResult: what an alignment comes to,
+  // S1[startI..endI - 1] against S2[startJ..endJ - 1] (0 based),
+  // cigar left to right
+
+struct alignResult
+{
+  int score;
+  int startI, startJ;
+  int endI, endJ;
+  int columns;
+  int matchCount;
+  int mismatchCount;
+  int gapCount;
+  int openingGap;
+  vector <uint32_t> cigar;
+};
+
+  // cigarOp / cigarLength: the two halves of a run
+
+static inline int cigarOp (uint32_t run)
+{
+  return run & 15;
+}
+
+static inline int cigarLength (uint32_t run)
+{
+  return run >> 4;
+}
+
+  // cigarPath: the runs of tracePath (traceback.h), which hands
+  // them over last column first, and where the alignment starts
+
+struct cigarPath
+{
+  string &S1;
+  string &S2;
+  vector <uint32_t> &cigar;
+  int startI, startJ;
+
+  void step (int state, int i, int j)
+  {
+    int op = (state == 1) ? CIGAR_INS :
+             (state == 2) ? CIGAR_DEL :
+             (S1[i-1] == S2[j-1]) ? CIGAR_MATCH : CIGAR_MISMATCH;
+
+    if (!cigar.empty () && cigarOp (cigar.back ()) == op)
+    {
+      cigar.back () += 16;
+    }
+    else
+    {
+      cigar.push_back (16 | op);
+    }
+
+    startI = i - (state != 2);
+    startJ = j - (state != 1);
+  }
+};
+
+  // cigarStart function:
+  // a cleared result and the path that fills it, ending at (i,j)
+
+cigarPath cigarStart (string &S1, string &S2, alignResult &result,
+                       int i, int j)
+{
+  result.cigar.clear ();
+  result.endI = i;
+  result.endJ = j;
+
+  cigarPath path = { S1, S2, result.cigar, i, j };
+
+  return path;
+
+} // end cigarStart function
+
+  // cigarFinish function:
+  // puts the runs of a finished path left to right and counts them
+
+void cigarFinish (cigarPath &path, alignResult &result)
+{
+  result.startI = path.startI;
+  result.startJ = path.startJ;
+  result.columns = 0;
+  result.matchCount = 0;
+  result.mismatchCount = 0;
+  result.gapCount = 0;
+  result.openingGap = 0;
+
+  reverse (result.cigar.begin (), result.cigar.end ());
+
+  for (size_t r = 0; r < result.cigar.size (); r++)
+  {
+    int op = cigarOp (result.cigar[r]);
+    int length = cigarLength (result.cigar[r]);
+
+    result.columns += length;
+
+    if (op == CIGAR_MATCH)
+    {
+      result.matchCount += length;
+    }
+    else if (op == CIGAR_MISMATCH)
+    {
+      result.mismatchCount += length;
+    }
+    else
+    {
+      result.gapCount += length;
+      result.openingGap++;
+    } // end else, a run of gaps
+  } // end for each run
+
+} // end cigarFinish function
+
+  // tallyResult function:
+  // adds the counts of a result, as tallyAlignment does
+
+void tallyResult (alignResult &result, int *matchCount, int *mismatchCount,
+                   int *gapCount, int *openingGap)
+{
+  *matchCount = *matchCount + result.matchCount;
+  *mismatchCount = *mismatchCount + result.mismatchCount;
+  *gapCount = *gapCount + result.gapCount;
+  *openingGap = *openingGap + result.openingGap;
+
+} // end tallyResult function
+
+  // cigarString function:
+  // the CIGAR as text, "*" if there are no columns
+
+string cigarString (alignResult &result)
+{
+  string text;
+
+  for (size_t r = 0; r < result.cigar.size (); r++)
+  {
+    text += to_string (cigarLength (result.cigar[r]));
+    text += CIGAR_OPS[cigarOp (result.cigar[r])];
+  }
+
+  return (text.length () > 0) ? text : "*";
+
+} // end cigarString function
+
+  // printCigarRow function:
+  // one row of printCigarAlignment, the same three lines as
+  // printAlignment prints
+
+static void printCigarRow (char *row1, char *link, char *row2, int columns,
+                            int *S1Index, int *S2Index)
+{
+  cout << "S1 " << setw(5) << *S1Index << " ";
+
+  for (int c = 0; c < columns; c++)
+  {
+    *S1Index += (row1[c] != '-');
+  }
+
+  cout.write (row1, columns);
+  cout << setw(5) << *S1Index << endl;
+  *S1Index = *S1Index + 1;
+
+  cout << setw(10) << link[0];
+  cout.write (link + 1, columns - 1);
+  cout << endl;
+
+  cout << "S2 " << setw(5) << *S2Index << " ";
+
+  for (int c = 0; c < columns; c++)
+  {
+    *S2Index += (row2[c] != '-');
+  }
+
+  cout.write (row2, columns);
+  cout << setw(5) << *S2Index << endl << endl;
+  *S2Index = *S2Index + 1;
+
+} // end printCigarRow function
+
+  // printCigarAlignment function:
+  // printAlignment for a result, reading the characters from S1 / S2
+  // as it goes
+
+void printCigarAlignment (string &S1, string &S2, alignResult &result)
+{
+  char row1[60], link[60], row2[60];
+  int columns = 0;
+  int S1Index = 0, S2Index = 0;
+  int i = result.startI, j = result.startJ;
+
+  for (size_t r = 0; r < result.cigar.size (); r++)
+  {
+    int op = cigarOp (result.cigar[r]);
+
+    for (int c = cigarLength (result.cigar[r]); c > 0; c--)
+    {
+      row1[columns] = (op == CIGAR_DEL) ? '-' : S1[i++];
+      row2[columns] = (op == CIGAR_INS) ? '-' : S2[j++];
+      link[columns] = (op == CIGAR_MATCH) ? '|' : ' ';
+      columns++;
+
+      if (columns == 60)
+      {
+        printCigarRow (row1, link, row2, columns, &S1Index, &S2Index);
+        columns = 0;
+      }
+    } // end for each column of the run
+  } // end for each run
+
+  if (columns > 0)
+  {
+    printCigarRow (row1, link, row2, columns, &S1Index, &S2Index);
+  }
+
+} // end printCigarAlignment function
+
+#endif
@@ -0,0 +1,207 @@
+/*
+* Cpt_S 471
+* Programming Assignment #1
+*
+* dpArena.h
+*
+* One contiguous block of memory for the DP tables of an alignment
+* (the traceback codes, the wavefront edges, the lanes tables).
+* take () hands out 64 byte aligned pieces of it, reset () gives
+* them all back at once so the next alignment reuses the same
+* memory: no malloc / free per row or per table, and the pages are
+* already mapped.  A batch worker keeps one arena for all its pairs.
+*
+* If an alignment needs more than the block holds, take () starts
+* another block; the next reset () puts them back together as one
+* block of the combined size.  The memory goes back to the system
+* in release () or when the arena goes away.
+*
+* peak is the most bytes take () has handed out between two resets
+* (what the tables needed, not the size of the blocks they came
+* from), for the report (runStats.h).
+*
+* With hugePages, blocks of 2 MB or more are 2 MB aligned and
+* marked for transparent huge pages (Linux), fewer page faults and
+* TLB misses on big tables.
+*
+*/
+
+#ifndef DPARENA_H
+#define DPARENA_H
+
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include <sys/mman.h>
+
+using namespace std;
+
+#define ARENA_ALIGN 64
+#define ARENA_HUGE_PAGE (2 << 20)
+#define ARENA_MIN_BLOCK (1 << 20)
+
+  // arenaBlock: one piece of memory from the system
+
+struct arenaBlock
+{
+  unsigned char *data;
+  size_t size;
+  size_t used;
+};
+
+struct dpArena
+{
+  vector <arenaBlock> blocks;
+  bool hugePages;
+  size_t taken;
+  size_t peak;
+
+  dpArena (bool theHugePages)
+  {
+    hugePages = theHugePages;
+    taken = 0;
+    peak = 0;
+  }
+
+  ~dpArena ()
+  {
+    release ();
+  }
+
+    // newBlock: get a block of at least "size" bytes from the system
+    // returns false if out of memory
+
+  bool newBlock (size_t size)
+  {
+    arenaBlock theBlock;
+    size_t align = ARENA_ALIGN;
+    void *memory = NULL;
+
+    if (size < ARENA_MIN_BLOCK)
+    {
+      size = ARENA_MIN_BLOCK;
+    }
+
+    if (hugePages && size >= ARENA_HUGE_PAGE)
+    {
+      align = ARENA_HUGE_PAGE;
+      size = (size + ARENA_HUGE_PAGE - 1) / ARENA_HUGE_PAGE * ARENA_HUGE_PAGE;
+    } // end if big enough for huge pages
+
+    if (posix_memalign (&memory, align, size) != 0)
+    {
+      return false;
+    }
+
+#ifdef MADV_HUGEPAGE
+    if (align == ARENA_HUGE_PAGE)
+    {
+      madvise (memory, size, MADV_HUGEPAGE);
+    }
+#endif
+
+    theBlock.data = (unsigned char *) memory;
+    theBlock.size = size;
+    theBlock.used = 0;
+    blocks.push_back (theBlock);
+
+    return true;
+  }
+
+    // take: "bytes" bytes, 64 byte aligned, not cleared
+    // returns NULL if out of memory
+
+  void *take (size_t bytes)
+  {
+    bytes = (bytes + ARENA_ALIGN - 1) / ARENA_ALIGN * ARENA_ALIGN;
+
+    if (blocks.empty () || blocks.back ().size - blocks.back ().used < bytes)
+    {
+      size_t grow = blocks.empty () ? 0 : capacity ();
+
+      if (!newBlock ( (bytes > grow) ? bytes : grow) )
+      {
+        return NULL;
+      }
+    } // end if the last block is full, start another
+
+    arenaBlock &theBlock = blocks.back ();
+    void *piece = theBlock.data + theBlock.used;
+
+    theBlock.used += bytes;
+    taken += bytes;
+
+    if (taken > peak)
+    {
+      peak = taken;
+    }
+
+    return piece;
+  }
+
+    // reset: everything taken is free again (the memory is kept),
+    // more than one block becomes a single block of the same size
+
+  void reset ()
+  {
+    if (blocks.size () > 1)
+    {
+      size_t total = capacity ();
+
+      release ();
+      newBlock (total);
+    } // end if the last alignment needed more than one block
+
+    for (size_t b = 0; b < blocks.size (); b++)
+    {
+      blocks[b].used = 0;
+    }
+
+    taken = 0;
+  }
+
+    // reserve: reset, with one block big enough for "bytes" in a
+    // few pieces, so a table of known size never starts a second
+    // block (which would be at least as big as the first)
+
+  void reserve (size_t bytes)
+  {
+    bytes += 16 * ARENA_ALIGN;
+    reset ();
+
+    if (capacity () < bytes)
+    {
+      release ();
+      newBlock (bytes);
+    } // end if too small, start again with the size needed
+  }
+
+    // release: give the memory back to the system
+
+  void release ()
+  {
+    for (size_t b = 0; b < blocks.size (); b++)
+    {
+      free (blocks[b].data);
+    }
+
+    blocks.clear ();
+    taken = 0;
+  }
+
+    // capacity: bytes held, used or not
+
+  size_t capacity ()
+  {
+    size_t total = 0;
+
+    for (size_t b = 0; b < blocks.size (); b++)
+    {
+      total += blocks[b].size;
+    }
+
+    return total;
+  }
+};
+
+#endif
@@ -0,0 +1,730 @@
+/*
+* Cpt_S 471
+* Programming Assignment #1
+*
+* interSeq.h
+*
+* Global alignment of many short pairs at once: each SIMD lane
+* holds a different pair (32 lanes with AVX-512, 16 with AVX2,
+* 8 with SSE4.1), and every cell (i,j) is worked out for all of
+* them with one set of vector operations.  The table keeps the
+* same traceback code per cell as runGlobal (traceback.h),
+* one per lane, and each lane is traced back on its own, so every
+* pair gets the same alignment runGlobal would give it.
+*
+* The pairs are sorted by length first so the pairs sharing a
+* table are about the same size.  Scores start out 8 bit, twice
+* the lanes of 16 bit scores.  A lane whose scores get too close to
+* the ends of that range is flagged and its pair goes again with
+* 16 bit scores, and if that is still too small (or a sequence is
+* empty) through alignPair, with ints.  The adds stop at the ends
+* of the range instead of wrapping around (laneAdd, scoreWidth.h),
+* so a lane that runs past them stays there to be flagged.
+*
+* With a substitution matrix (a protein run with BLOSUM62, or a
+* matrix file) the lanes can't just compare characters.  The pairs
+* are grouped by query instead, so every lane of a table has the
+* same S1, and for each residue of S1 a query profile holds its
+* score against every lane's character of each column; a cell reads
+* one vector from the profile of its row's residue (as SWIPE does).
+*
+*/
+
+#ifndef INTERSEQ_H
+#define INTERSEQ_H
+
+#include <string.h>
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include "alignCore.h"
+#include "traceback.h"
+#include "cigar.h"
+#include "pairAlign.h"
+#include "stripedLocal.h"
+#include "scoreWidth.h"
+#include "scoring.h"
+#include "dpArena.h"
+
+using namespace std;
+
+  // laneCodes: the traceback codes of one lane, with the
+  // traceMatrix get (i, j) so tracePath can walk them
+
+template <class V>
+struct laneCodes
+{
+  V *codes;
+  int cols;
+  int lane;
+
+  int get (int i, int j)
+  {
+    if (i <= 0 || j <= 0)
+    {
+      return TRACE_ZERO;
+    }
+
+    return codes[ (size_t) i * cols + j][lane];
+  }
+};
+
+  // laneMargin function:
+  // the most one step (a substitution, or opening or extending
+  // a gap) can change a score by
+
+int laneMargin (int match, int mismatch, int g, int h)
+{
+  int margin = (match < 0) ? -match : match;
+
+  if ( (mismatch < 0 ? -mismatch : mismatch) > margin)
+  {
+    margin = (mismatch < 0) ? -mismatch : mismatch;
+  }
+  if ( (g < 0 ? -g : g) > margin)
+  {
+    margin = (g < 0) ? -g : g;
+  }
+  if ( (h + g < 0 ? -(h + g) : h + g) > margin)
+  {
+    margin = (h + g < 0) ? -(h + g) : h + g;
+  }
+
+  return margin;
+
+} // end laneMargin function
+
+  // laneFits function:
+  // true if this pair can go in the lanes of V: the scores of
+  // one step leave room between the edges of the lane, and the
+  // zeroeth row and column (all gaps) stay inside that room
+  // (the rest of the table is checked as it is filled in)
+
+template <class V>
+bool laneFits (string &A, string &B, int match, int mismatch, int g, int h)
+{
+  long long margin = laneMargin (match, mismatch, g, h);
+  long long low = scoreWidth <V>::minusInfinity () + margin;
+  long long high = scoreWidth <V>::high () - margin;
+  long long longest = (A.size () > B.size ()) ? A.size () : B.size ();
+  long long edge = h + longest * g;
+
+  if (A.size () == 0 || B.size () == 0)
+  {
+    return false;
+  } // end if nothing to put in the lanes
+
+  return (4 * margin < high - low) && (edge >= low) && (edge <= high) &&
+         (h + g >= low) && (h + g <= high);
+
+} // end laneFits function
+
+  // lanesBody function:
+  // aligns the "count" pairs A[pick[k]] / B[pick[k]] (count <= lanes)
+  // together, only ever inlined into lanesAVX512 / lanesAVX2 /
+  // lanesSSE41 so it is compiled for that instruction set
+  // PROFILE: the scores come from "table" through a query profile,
+  // and every pair has the same A (match / mismatch are then the
+  // highest and lowest score of the table); else match / mismatch
+  // a pair whose scores got too close to the ends of the lane
+  // gets no result, it is added to "redo" instead
+  // returns false if out of memory
+
+template <class V, bool PROFILE>
+static inline __attribute__ ((always_inline))
+bool lanesBody (vector <string> &A, vector <string> &B, int *pick, int count,
+                 int match, int mismatch, const scoreTable *table,
+                 int g, int h, dpArena &arena,
+                 vector <alignResult> &results, vector <int> &redo)
+{
+  typedef typename scoreWidth <V>::score lane;
+  const int L = scoreWidth <V>::lanes ();
+  int floor = scoreWidth <V>::minusInfinity ();
+  int margin = laneMargin (match, mismatch, g, h);
+  int rows = 0, cols = 0;
+  int lenA[L], lenB[L];
+  int i = 0, j = 0, k = 0;
+
+  for (k = 0; k < L; k++)
+  {
+    lenA[k] = (k < count) ? A[pick[k]].size () : 0;
+    lenB[k] = (k < count) ? B[pick[k]].size () : 0;
+
+    if (lenA[k] > rows)
+    {
+      rows = lenA[k];
+    }
+    if (lenB[k] > cols)
+    {
+      cols = lenB[k];
+    }
+  } // end find the table size
+
+  rows++;
+  cols++;
+
+  V vZero = {};
+  V vMatch = vZero + (lane) match;
+  V vMismatch = vZero + (lane) mismatch;
+  V vG = vZero + (lane) g;
+  V vHG = vZero + (lane) (h + g);
+  V vInf = vZero + (lane) floor;
+  V vOne = vZero + (lane) 1;
+  V vTwo = vZero + (lane) 2;
+  V vDelExt = vZero + (lane) TRACE_DEL_EXTEND;
+  V vInsExt = vZero + (lane) TRACE_INS_EXTEND;
+  V vDelFromIns = vZero + (lane) TRACE_DEL_FROM_INS;
+  V vInsFromDel = vZero + (lane) TRACE_INS_FROM_DEL;
+
+    // the lowest deletion / insertion and the highest score of
+    // each lane: a score below floor + margin or above high - margin
+    // is too close to the ends of the lane, one more step could
+    // wrap around (cells outside a pair's table count as 0)
+
+  int low = floor + margin;
+  int high = scoreWidth <V>::high () - margin;
+  V vLowest = vZero;
+  V vHighest = vZero;
+
+    // the characters of every lane, one vector per position
+    // (positions past the end of a pair's sequence are 0), and
+    // which lanes are still inside their pair's table there
+
+  arena.reset ();
+
+  V *charA = (V *) arena.take (rows * sizeof (V));
+  V *rowInside = (V *) arena.take (rows * sizeof (V));
+  V *charB = (V *) arena.take (cols * sizeof (V));
+  V *colInside = (V *) arena.take (cols * sizeof (V));
+  V *codes = (V *) arena.take ( (size_t) rows * cols * sizeof (V));
+  V *prevD = (V *) arena.take (cols * sizeof (V));
+  V *prevI = (V *) arena.take (cols * sizeof (V));
+  V *prevH = (V *) arena.take (cols * sizeof (V));
+  V *prevS = (V *) arena.take (cols * sizeof (V));
+  V *curD = (V *) arena.take (cols * sizeof (V));
+  V *curI = (V *) arena.take (cols * sizeof (V));
+  V *curH = (V *) arena.take (cols * sizeof (V));
+  V *curS = (V *) arena.take (cols * sizeof (V));
+  V vScore = vZero;
+
+    // query profile (PROFILE): A is the same in every lane, so for
+    // each code that shows up in it, profile[index * cols + j] is
+    // the score of that code against each lane's character of
+    // column j, and a row reads its substitution scores from the
+    // profile of its character
+
+  int profileIndex[SCORE_ALPHABET];
+  int profileCount = 0;
+  V *profile = NULL;
+
+  if (PROFILE)
+  {
+    string &theA = A[pick[0]];
+
+    for (k = 0; k < SCORE_ALPHABET; k++)
+    {
+      profileIndex[k] = -1;
+    }
+
+    for (i = 0; i < (int) theA.size (); i++)
+    {
+      if (profileIndex[scoreCode (theA[i])] < 0)
+      {
+        profileIndex[scoreCode (theA[i])] = profileCount;
+        profileCount++;
+      }
+    }
+
+    profile = (V *) arena.take ( (size_t) profileCount * cols * sizeof (V));
+
+    if (profile == NULL && profileCount > 0)
+    {
+      return false;
+    }
+  } // end if scoring from the table
+
+  if (charA == NULL || charB == NULL || codes == NULL ||
+      rowInside == NULL || colInside == NULL ||
+      prevD == NULL || prevI == NULL || prevH == NULL || prevS == NULL ||
+      curD == NULL || curI == NULL || curH == NULL || curS == NULL)
+  {
+    return false;
+  } // end if out of memory
+
+  for (i = 1; i < rows; i++)
+  {
+    V vChar = vZero;
+    V vInside = vZero;
+
+    for (k = 0; k < count; k++)
+    {
+      vChar[k] = (i <= lenA[k]) ? (unsigned char) A[pick[k]][i-1] : 0;
+      vInside[k] = (i <= lenA[k]) ? -1 : 0;
+    }
+
+    charA[i] = vChar;
+    rowInside[i] = vInside;
+  } // end for each row
+
+  for (j = 1; j < cols; j++)
+  {
+    V vChar = vZero;
+    V vInside = vZero;
+
+    for (k = 0; k < count; k++)
+    {
+      vChar[k] = (j <= lenB[k]) ? (unsigned char) B[pick[k]][j-1] : 0;
+      vInside[k] = (j <= lenB[k]) ? -1 : 0;
+    }
+
+    charB[j] = vChar;
+    colInside[j] = vInside;
+  } // end for each column
+
+  for (int c = 0; PROFILE && c < SCORE_ALPHABET; c++)
+  {
+    if (profileIndex[c] < 0)
+    {
+      continue;
+    }
+
+    V *codeProfile = &profile[ (size_t) profileIndex[c] * cols];
+
+    for (j = 1; j < cols; j++)
+    {
+      V vProfile = vZero;
+
+      for (k = 0; k < count; k++)
+      {
+        vProfile[k] = (j <= lenB[k]) ? table->sub[c][scoreCode (B[pick[k]][j-1])]
+                                     : 0;
+      }
+
+      codeProfile[j] = vProfile;
+    }
+  } // end build query profile
+
+    // the zeroeth row, set up the way runGlobal does
+
+  prevD[0] = vZero;
+  prevI[0] = vZero;
+  prevH[0] = vZero;
+  prevS[0] = vZero;
+
+  for (j = 1; j < cols; j++)
+  {
+    lane edge = (h + (j * g) < floor) ? floor : h + (j * g);
+
+    prevS[j] = vInf;
+    prevD[j] = vInf;
+    prevI[j] = vZero + edge;
+    prevH[j] = prevI[j];
+  } // end the zeroeth row, past a pair's end it can be anything
+
+  for (i = 1; i < rows; i++)
+  {
+    V vA = charA[i];
+    V *rowProfile = NULL;
+    V *rowCodes = &codes[ (size_t) i * cols];
+    V vRowLow = vZero;
+    V vRowHigh = vZero;
+    lane edge = (h + (i * g) < floor) ? floor : h + (i * g);
+
+      // the zeroeth column
+
+    curS[0] = vInf;
+    curD[0] = vZero + edge;
+    curI[0] = vInf;
+    curH[0] = curD[0];
+
+    if (PROFILE)
+    {
+      rowProfile = &profile[ (size_t) profileIndex[scoreCode (A[pick[0]][i-1])] *
+                             cols];
+    }
+
+    for (j = 1; j < cols; j++)
+    {
+      V vSub = laneAdd (prevH[j-1],
+                        PROFILE ? rowProfile[j]
+                                : ( (vA == charB[j]) ? vMatch : vMismatch));
+
+        // Deletion: extend the one above, or open a new one after
+        // the substitution or insertion above (as globalCell does)
+
+      V vFrom = (prevI[j] > prevS[j]);
+      V vExt = laneAdd (prevD[j], vG);
+      V vOpen = laneAdd (vFrom ? prevI[j] : prevS[j], vHG);
+      V vDelFlag = (vExt >= vOpen);
+      V vDel = vDelFlag ? vExt : vOpen;
+      V vDelCode = vDelFlag ? vDelExt : (vFrom & vDelFromIns);
+
+        // Insertion: extend the one to the left, or open a new one
+        // after the substitution or deletion to the left
+
+      vFrom = (curD[j-1] > curS[j-1]);
+      vExt = laneAdd (curI[j-1], vG);
+      vOpen = laneAdd (vFrom ? curD[j-1] : curS[j-1], vHG);
+
+      V vInsFlag = (vExt >= vOpen);
+      V vIns = vInsFlag ? vExt : vOpen;
+      V vInsCode = vInsFlag ? vInsExt : (vFrom & vInsFromDel);
+
+        // best state, ties to the lowest (as maxState does)
+
+      V vMax = (vDel > vSub) ? vDel : vSub;
+      V vState = (vDel > vSub) ? vOne : vZero;
+
+      vState = (vIns > vMax) ? vTwo : vState;
+      vMax = (vIns > vMax) ? vIns : vMax;
+
+      rowCodes[j] = vState | vDelCode | vInsCode;
+
+      curS[j] = vSub;
+      curD[j] = vDel;
+      curI[j] = vIns;
+      curH[j] = vMax;
+
+        // only the lanes still inside their own table count
+
+      V vLower = ( (vDel < vIns) ? vDel : vIns) & colInside[j];
+      V vHigher = vMax & colInside[j];
+
+      vRowLow = (vLower < vRowLow) ? vLower : vRowLow;
+      vRowHigh = (vHigher > vRowHigh) ? vHigher : vRowHigh;
+
+    } // end for each column
+
+    vRowLow &= rowInside[i];
+    vRowHigh &= rowInside[i];
+    vLowest = (vRowLow < vLowest) ? vRowLow : vLowest;
+    vHighest = (vRowHigh > vHighest) ? vRowHigh : vHighest;
+
+      // a pair ending in this row: its score is in its last column
+
+    for (k = 0; k < count; k++)
+    {
+      if (lenA[k] == i)
+      {
+        vScore[k] = curH[lenB[k]][k];
+      }
+    }
+
+    V *swapHold = prevD;
+    prevD = curD;
+    curD = swapHold;
+
+    swapHold = prevI;
+    prevI = curI;
+    curI = swapHold;
+
+    swapHold = prevH;
+    prevH = curH;
+    curH = swapHold;
+
+    swapHold = prevS;
+    prevS = curS;
+    curS = swapHold;
+
+  } // end for each row
+
+    // trace each lane back on its own
+
+  for (k = 0; k < count; k++)
+  {
+    if (vLowest[k] < low || vHighest[k] > high)
+    {
+      redo.push_back (pick[k]);
+      continue;
+    } // end if this pair needs wider scores
+
+    laneCodes <V> theCodes;
+    alignResult &theResult = results[pick[k]];
+    int last = codes[ (size_t) lenA[k] * cols + lenB[k]][k];
+
+    theCodes.codes = codes;
+    theCodes.cols = cols;
+    theCodes.lane = k;
+
+    cigarPath path = cigarStart (A[pick[k]], B[pick[k]], theResult,
+                                 lenA[k], lenB[k]);
+
+    tracePath (theCodes, lenA[k], lenB[k], last & TRACE_STATE,
+               ALIGN_GLOBAL, path);
+
+    cigarFinish (path, theResult);
+    theResult.score = vScore[k];
+
+  } // end for each lane
+
+  return true;
+
+} // end lanesBody function
+
+  // the lanes kernel for each instruction set, V picks the
+  // score width (8 or 16 bit lanes)
+
+template <class V, bool PROFILE>
+__attribute__ ((target ("avx512bw")))
+bool lanesAVX512 (vector <string> &A, vector <string> &B, int *pick, int count,
+                   int match, int mismatch, const scoreTable *table,
+                   int g, int h, dpArena &arena,
+                   vector <alignResult> &results, vector <int> &redo)
+{
+  return lanesBody <V, PROFILE> (A, B, pick, count, match, mismatch, table,
+                                 g, h, arena, results, redo);
+}
+
+template <class V, bool PROFILE>
+__attribute__ ((target ("avx2")))
+bool lanesAVX2 (vector <string> &A, vector <string> &B, int *pick, int count,
+                 int match, int mismatch, const scoreTable *table,
+                 int g, int h, dpArena &arena,
+                 vector <alignResult> &results, vector <int> &redo)
+{
+  return lanesBody <V, PROFILE> (A, B, pick, count, match, mismatch, table,
+                                 g, h, arena, results, redo);
+}
+
+template <class V, bool PROFILE>
+__attribute__ ((target ("sse4.1")))
+bool lanesSSE41 (vector <string> &A, vector <string> &B, int *pick, int count,
+                  int match, int mismatch, const scoreTable *table,
+                  int g, int h, dpArena &arena,
+                  vector <alignResult> &results, vector <int> &redo)
+{
+  return lanesBody <V, PROFILE> (A, B, pick, count, match, mismatch, table,
+                                 g, h, arena, results, redo);
+}
+
+  // lanesRun function:
+  // runs the pairs in "order" through the lanes of V (the
+  // instruction set goes by the size of V), longest first so the
+  // pairs sharing a table are about the same size, and adds the
+  // pairs that didn't fit to "redo"
+  // PROFILE: the pairs with the same A go together (one query
+  // against many targets), the scores come from "table"
+  // returns the number of pairs that got a result
+
+template <class V, bool PROFILE>
+int lanesRun (vector <string> &A, vector <string> &B, vector <int> &order,
+               int match, int mismatch, const scoreTable *table,
+               int g, int h, dpArena &arena,
+               vector <alignResult> &results, vector <int> &redo)
+{
+  int lanes = scoreWidth <V>::lanes ();
+  int laned = 0;
+
+  sort (order.begin (), order.end (), [&] (int x, int y)
+  {
+    if (PROFILE && A[x] != A[y])
+    {
+      return (A[x].size () != A[y].size ()) ? (A[x].size () > A[y].size ())
+                                            : (A[x] < A[y]);
+    } // end if a different query, longest query first
+
+    return (A[x].size () + B[x].size ()) > (A[y].size () + B[y].size ());
+  });
+
+  int start = 0;
+
+  while (start < (int) order.size ())
+  {
+    int count = order.size () - start;
+    int redone = redo.size ();
+    bool done = false;
+
+    if (count > lanes)
+    {
+      count = lanes;
+    }
+
+    for (int k = 1; PROFILE && k < count; k++)
+    {
+      if (A[order[start + k]] != A[order[start]])
+      {
+        count = k;
+      }
+    } // end if the query changes, stop the group there
+
+    if (sizeof (V) == 64)
+    {
+      done = lanesAVX512 <V, PROFILE> (A, B, &order[start], count, match,
+                                       mismatch, table, g, h, arena,
+                                       results, redo);
+    }
+    else if (sizeof (V) == 32)
+    {
+      done = lanesAVX2 <V, PROFILE> (A, B, &order[start], count, match,
+                                     mismatch, table, g, h, arena,
+                                     results, redo);
+    }
+    else
+    {
+      done = lanesSSE41 <V, PROFILE> (A, B, &order[start], count, match,
+                                      mismatch, table, g, h, arena,
+                                      results, redo);
+    }
+
+    if (done)
+    {
+      laned += count - (redo.size () - redone);
+    } // end if the lanes did it
+    else
+    {
+      for (int k = start; k < start + count; k++)
+      {
+        redo.push_back (order[k]);
+      }
+    } // end else, out of memory, every pair goes again
+
+    start += count;
+
+  } // end for each group of pairs
+
+  return laned;
+
+} // end lanesRun function
+
+  // lanesAll function:
+  // every pair that fits goes through the 8 bit lanes (NARROW)
+  // first, the ones that didn't fit there through the 16 bit lanes
+  // (WIDE), and the rest are added to "rest"
+  // the scores are match / mismatch, or with a table (not NULL)
+  // from the query profile, match / mismatch its highest and lowest
+  // returns the number of pairs that got a result
+
+template <class NARROW, class WIDE>
+int lanesAll (vector <string> &A, vector <string> &B,
+               int match, int mismatch, const scoreTable *table,
+               int g, int h, dpArena &arena,
+               vector <alignResult> &results, vector <int> &rest)
+{
+  vector <int> narrow, wide, redo;
+  int laned = 0;
+
+  for (int p = 0; p < (int) A.size (); p++)
+  {
+    if (laneFits <NARROW> (A[p], B[p], match, mismatch, g, h))
+    {
+      narrow.push_back (p);
+    }
+    else
+    {
+      redo.push_back (p);
+    }
+  } // end for each pair
+
+  if (table != NULL)
+  {
+    laned = lanesRun <NARROW, true> (A, B, narrow, match, mismatch, table,
+                                     g, h, arena, results, redo);
+  }
+  else
+  {
+    laned = lanesRun <NARROW, false> (A, B, narrow, match, mismatch, table,
+                                      g, h, arena, results, redo);
+  }
+
+  for (int k = 0; k < (int) redo.size (); k++)
+  {
+    if (laneFits <WIDE> (A[redo[k]], B[redo[k]], match, mismatch, g, h))
+    {
+      wide.push_back (redo[k]);
+    }
+    else
+    {
+      rest.push_back (redo[k]);
+    }
+  } // end for each pair too big for 8 bits
+
+  if (table != NULL)
+  {
+    laned += lanesRun <WIDE, true> (A, B, wide, match, mismatch, table,
+                                    g, h, arena, results, rest);
+  }
+  else
+  {
+    laned += lanesRun <WIDE, false> (A, B, wide, match, mismatch, table,
+                                     g, h, arena, results, rest);
+  }
+
+  return laned;
+
+} // end lanesAll function
+
+  // alignMany function:
+  // global alignment of every pair A[p] / B[p], results[p] gets the
+  // score, CIGAR and counts (cigar.h), the same as runGlobal would report
+  // kernel is set to the name of the kernel that was used
+  // every table comes from "arena", one group / pair after another
+  // match / mismatch scoring compares the characters in the lanes,
+  // any other scoring (a matrix) goes through a query profile, with
+  // the pairs that have the same A sharing the lanes
+  // returns the number of pairs that went through the lanes
+
+int alignMany (vector <string> &A, vector <string> &B,
+                scoreScheme &scoring, int g, int h, dpArena &arena,
+                vector <alignResult> &results, string *kernel)
+{
+  int pairCount = A.size ();
+  int laned = 0;
+  int match = scoring.match;
+  int mismatch = scoring.mismatch;
+  const scoreTable *table = NULL;
+  string scored;
+  vector <int> rest;
+
+  results.resize (pairCount);
+
+  if (!scoring.matchOnly ())
+  {
+    match = scoring.high;
+    mismatch = scoring.low;
+    table = &scoring.table;
+    scored = ", query profile (" + scoring.name + " scoring)";
+  } // end if a matrix, the lanes score from its query profile
+
+  if (__builtin_cpu_supports ("avx512bw"))
+  {
+    *kernel = "AVX-512, 64 lanes (8 bit) / 32 lanes (16 bit)" + scored;
+    laned = lanesAll <v64qi, v32hi> (A, B, match, mismatch, table, g, h,
+                                     arena, results, rest);
+  }
+  else if (__builtin_cpu_supports ("avx2"))
+  {
+    *kernel = "AVX2, 32 lanes (8 bit) / 16 lanes (16 bit)" + scored;
+    laned = lanesAll <v32qi, v16hi> (A, B, match, mismatch, table, g, h,
+                                     arena, results, rest);
+  }
+  else if (__builtin_cpu_supports ("sse4.1"))
+  {
+    *kernel = "SSE4.1, 16 lanes (8 bit) / 8 lanes (16 bit)" + scored;
+    laned = lanesAll <v16qi, v8hi> (A, B, match, mismatch, table, g, h,
+                                    arena, results, rest);
+  }
+  else
+  {
+    *kernel = "scalar";
+
+    for (int p = 0; p < pairCount; p++)
+    {
+      rest.push_back (p);
+    }
+  }
+
+    // what's left goes one at a time, with ints
+
+  for (int k = 0; k < (int) rest.size (); k++)
+  {
+    int p = rest[k];
+
+    alignPair (A[p], B[p], scoring, g, h, ALIGN_GLOBAL, 1, &arena,
+               results[p]);
+  } // end for each pair left
+
+  return laned;
+
+} // end alignMany function
+
+#endif
@@ -0,0 +1,582 @@
+/*
+* Cpt_S 471
+* Programming Assignment #1
+*
+* linearSpace.h
+*
+* Global alignment with affine gaps in linear space
+* (divide and conquer, Hirschberg / Myers and Miller style)
+*
+* Instead of the full n x m table of ADP_cell's that runGlobal uses,
+* only two rows of m + 1 cells are kept.  Each forward pass also
+* carries, for every cell and state, the column where its traceback
+* crosses the middle row.  That tells us exactly where the alignment
+* runGlobal would print crosses the middle row, so the top and bottom
+* halves are aligned the same way and the result is the same alignment
+* (and the same counts) as runGlobal, in about twice the time.
+* The traceback is part of the recursion, so the stats (runStats.h)
+* count it in the fill, with every cell of every pass.
+*
+*/
+
+#ifndef LINEARSPACE_H
+#define LINEARSPACE_H
+
+#include <string.h>
+#include <iostream>
+#include <vector>
+#include <climits>
+#include "alignCore.h"
+#include "traceback.h"
+#include "wavefront.h"
+#include "cigar.h"
+#include "scoring.h"
+#include "runStats.h"
+
+using namespace std;
+
+  // minus infinity for the linear space rows
+
+#define LINEAR_MINUS_INFINITY ADP_MINUS_INFINITY
+
+  // pieces smaller than this many cells are
+  // finished with a small full table
+
+#define LINEAR_BASE_CELLS 65536
+
+  // linearParams holds the scoring values and the
+  // working rows that every level of the recursion shares
+  // sub: the substitution scorer (scoring.h)
+
+template <class SCORER>
+struct linearParams
+{
+  SCORER sub;
+  int h;
+  int g;
+
+    // the row above and the row being filled
+
+  vector <ADP_cell> prevRow;
+  vector <ADP_cell> curRow;
+
+    // crossing of the middle row for each cell and state,
+    // stored as (column * 4 + state), three per cell
+
+  vector <int> prevCross;
+  vector <int> curCross;
+};
+
+  // noCell function:
+  // a cell no state can reach
+
+ADP_cell noCell ()
+{
+  ADP_cell theCell;
+
+  theCell.sub_score = LINEAR_MINUS_INFINITY;
+  theCell.del_score = LINEAR_MINUS_INFINITY;
+  theCell.ins_score = LINEAR_MINUS_INFINITY;
+
+  return theCell;
+
+} // end noCell function
+
+  // linearCell function:
+  // fills one cell from the cells up-left, up and left,
+  // (diag and left are NULL in the zeroeth column) with globalCell
+  // (wavefront.h), so the scores and the choices are the table's,
+  // and records which state each score came from:
+  // sSrc = state of the cell up-left,
+  // dSrc / iSrc = state of the cell up / left the gap came from
+  // returns the traceback code (traceback.h)
+
+int linearCell (ADP_cell *diag, ADP_cell *up, ADP_cell *left,
+                 int score, int h, int g, ADP_cell *out,
+                 int *sSrc, int *dSrc, int *iSrc)
+{
+  ADP_cell none = noCell ();
+  int code = globalCell ( (diag == NULL) ? none : *diag, *up,
+                          (left == NULL) ? none : *left,
+                          score, g, h, *out);
+
+  *sSrc = (diag == NULL) ? 0 : maxState (*diag);
+  *dSrc = (code & TRACE_DEL_EXTEND) ? 1 :
+          (code & TRACE_DEL_FROM_INS) ? 2 : 0;
+  *iSrc = (code & TRACE_INS_EXTEND) ? 2 :
+          (code & TRACE_INS_FROM_DEL) ? 1 : 0;
+
+  if (diag == NULL)
+  {
+    out->sub_score = LINEAR_MINUS_INFINITY;
+    out->ins_score = LINEAR_MINUS_INFINITY;
+    *iSrc = 2;
+  } // end if zeroeth column, only deletions
+
+  return code;
+
+} // end linearCell function
+
+  // startCell function:
+  // T(0,0) of a piece, only the state we arrived in is reachable
+  // state: 0 = substitution, 1 = deletion, 2 = insertion
+
+ADP_cell startCell (int state)
+{
+  ADP_cell theCell = noCell ();
+
+  if (state == 0)
+  {
+    theCell.sub_score = 0;
+  }
+  else if (state == 1)
+  {
+    theCell.del_score = 0;
+  }
+  else
+  {
+    theCell.ins_score = 0;
+  }
+
+  return theCell;
+
+} // end startCell function
+
+  // rowZeroCell function:
+  // T(0,j) of a piece, only insertions reach the zeroeth row:
+  // one gap, h + j * g from a start in a substitution or deletion
+  // (the zeroeth row of runGlobal), j * g on from a start in an
+  // insertion
+
+ADP_cell rowZeroCell (ADP_cell left, int h, int g)
+{
+  ADP_cell theCell;
+  ADP_cell none = noCell ();
+
+  globalCell (none, none, left, 0, g, h, theCell);
+
+  theCell.sub_score = LINEAR_MINUS_INFINITY;
+  theCell.del_score = LINEAR_MINUS_INFINITY;
+
+  return theCell;
+
+} // end rowZeroCell function
+
+  // linearPass function:
+  // fills rows 1 .. M of the piece A[aStart ..) x B[bStart ..)
+  // keeping only two rows.  X0 is the state the piece starts in.
+  // From row midi on, the middle row crossing is carried along.
+  // When done, prevRow / prevCross hold row M.
+
+template <class SCORER>
+void linearPass (string &A, int aStart, int M,
+                  string &B, int bStart, int N,
+                  int X0, int midi, linearParams <SCORER> *p)
+{
+  int i = 0, j = 0, k = 0;
+  int sSrc = 0, dSrc = 0, iSrc = 0;
+
+  vector <ADP_cell> &prev = p->prevRow;
+  vector <ADP_cell> &cur = p->curRow;
+  vector <int> &prevX = p->prevCross;
+  vector <int> &curX = p->curCross;
+
+    // row 0
+
+  prev[0] = startCell (X0);
+  statsCells ( (long long) M * N);
+
+  for (j = 1; j <= N; j++)
+  {
+    prev[j] = rowZeroCell (prev[j-1], p->h, p->g);
+  } // end initialize row 0
+
+  for (i = 1; i <= M; i++)
+  {
+    const int *subRow = p->sub.row (A[aStart + i - 1]);
+
+    linearCell (NULL, &prev[0], NULL, 0, p->h, p->g, &cur[0],
+                &sSrc, &dSrc, &iSrc);
+
+    if (i > midi)
+    {
+      curX[0] = -1;
+      curX[1] = prevX[dSrc];
+      curX[2] = -1;
+    } // end if below the middle row
+
+    for (j = 1; j <= N; j++)
+    {
+      linearCell (&prev[j-1], &prev[j], &cur[j-1],
+                  subRow[scoreCode (B[bStart + j - 1])],
+                  p->h, p->g, &cur[j], &sSrc, &dSrc, &iSrc);
+
+      if (i > midi)
+      {
+        curX[(3 * j)] = prevX[(3 * (j-1)) + sSrc];
+        curX[(3 * j) + 1] = prevX[(3 * j) + dSrc];
+        curX[(3 * j) + 2] = curX[(3 * (j-1)) + iSrc];
+      } // end if below the middle row
+
+    } // end inner loop (columns)
+
+      // on the middle row, every cell crosses at itself
+
+    if (i == midi)
+    {
+      for (j = 0; j <= N; j++)
+      {
+        for (k = 0; k < 3; k++)
+        {
+          curX[(3 * j) + k] = (j * 4) + k;
+        }
+      }
+    } // end if middle row
+
+    prev.swap (cur);
+    prevX.swap (curX);
+
+  } // end outer loop (rows)
+
+} // end linearPass function
+
+  // pushColumns function:
+  // adds "count" columns of one kind to the alignment
+  // kind: 0 = substitution, 1 = deletion, 2 = insertion
+
+void pushColumns (string &A, int aStart, string &B, int bStart,
+                   int count, int kind,
+                   vector <char> *theS1, vector <char> *theS2)
+{
+  for (int k = 0; k < count; k++)
+  {
+    if (kind == 0)
+    {
+      theS1->push_back (A[aStart + k]);
+      theS2->push_back (B[bStart + k]);
+    } // end if substitution
+    else if (kind == 1)
+    {
+      theS1->push_back (A[aStart + k]);
+      theS2->push_back ('-');
+    } // end else if deletion
+    else
+    {
+      theS1->push_back ('-');
+      theS2->push_back (B[bStart + k]);
+    } // end else, insertion
+
+  } // end for each column
+
+} // end pushColumns function
+
+  // pieceCodes: the traceback codes of a piece, with the
+  // traceMatrix get (i, j) so tracePath can walk them
+
+struct pieceCodes
+{
+  vector <int> codes;
+  int cols;
+
+  int get (int i, int j)
+  {
+    if (i <= 0 || j <= 0)
+    {
+      return TRACE_ZERO;
+    }
+
+    return codes[ (size_t) i * cols + j];
+  }
+};
+
+  // piecePath: the aligned characters of a piece, pushed last
+  // column first (charPath with the piece's offsets)
+
+struct piecePath
+{
+  string &A;
+  int aStart;
+  string &B;
+  int bStart;
+  vector <char> &pieceS1;
+  vector <char> &pieceS2;
+
+  void step (int state, int i, int j)
+  {
+    pieceS1.push_back ( (state == 2) ? '-' : A[aStart + i - 1]);
+    pieceS2.push_back ( (state == 1) ? '-' : B[bStart + j - 1]);
+  }
+};
+
+  // linearBase function:
+  // aligns a small piece with a full table and the same
+  // backtrace as runGlobal (tracePath), starting in state X0 and
+  // ending in state X1 (X1 = -1: end in the best state)
+  // returns the score of the last cell
+
+template <class SCORER>
+int linearBase (string &A, int aStart, int M,
+                 string &B, int bStart, int N,
+                 int X0, int X1, linearParams <SCORER> *p,
+                 vector <char> *theS1, vector <char> *theS2)
+{
+  int i = 0, j = 0, state = 0, score = 0;
+  int sSrc = 0, dSrc = 0, iSrc = 0;
+  vector <char> pieceS1, pieceS2;
+  pieceCodes T;
+
+  vector < vector <ADP_cell> > myTable (M + 1, vector <ADP_cell> (N + 1));
+
+  T.cols = N + 1;
+  T.codes.resize ( (size_t) (M + 1) * (N + 1));
+
+  myTable[0][0] = startCell (X0);
+  statsCells ( (long long) M * N);
+
+  for (j = 1; j <= N; j++)
+  {
+    myTable[0][j] = rowZeroCell (myTable[0][j-1], p->h, p->g);
+  }
+
+  for (i = 1; i <= M; i++)
+  {
+    linearCell (NULL, &myTable[i-1][0], NULL, 0, p->h, p->g,
+                &myTable[i][0], &sSrc, &dSrc, &iSrc);
+
+    for (j = 1; j <= N; j++)
+    {
+      T.codes[ (size_t) i * (N + 1) + j] =
+        linearCell (&myTable[i-1][j-1], &myTable[i-1][j], &myTable[i][j-1],
+                    p->sub (A[aStart + i - 1], B[bStart + j - 1]),
+                    p->h, p->g, &myTable[i][j], &sSrc, &dSrc, &iSrc);
+    }
+  } // end fill table
+
+  state = X1;
+
+  if (state < 0)
+  {
+    state = maxState (myTable[M][N]);
+  }
+
+  if (state == 0)
+  {
+    score = myTable[M][N].sub_score;
+  }
+  else if (state == 1)
+  {
+    score = myTable[M][N].del_score;
+  }
+  else
+  {
+    score = myTable[M][N].ins_score;
+  }
+
+    // backtrace, the same rules as runGlobal
+
+  piecePath path = { A, aStart, B, bStart, pieceS1, pieceS2 };
+
+  tracePath (T, M, N, state, ALIGN_GLOBAL, path);
+
+  for (i = pieceS1.size () - 1; i >= 0; i--)
+  {
+    theS1->push_back (pieceS1[i]);
+    theS2->push_back (pieceS2[i]);
+  } // end append piece in left to right order
+
+  return score;
+
+} // end linearBase function
+
+  // linearDiff function:
+  // aligns A[aStart .. aStart + M) with B[bStart .. bStart + N),
+  // starting in state X0 and ending in state X1
+  // (X1 = -1: end in the best state), and appends the columns,
+  // left to right, to theS1 / theS2
+  // returns the score of the last cell
+
+template <class SCORER>
+int linearDiff (string &A, int aStart, int M,
+                 string &B, int bStart, int N,
+                 int X0, int X1, linearParams <SCORER> *p,
+                 vector <char> *theS1, vector <char> *theS2)
+{
+  if ( (M <= 1) || (N <= 1) || ((long) M * N <= LINEAR_BASE_CELLS) )
+  {
+    return linearBase (A, aStart, M, B, bStart, N, X0, X1, p, theS1, theS2);
+  } // end if small enough for a full table
+
+    // fill the whole piece, carrying the crossing of the middle row
+
+  int midi = M / 2;
+  int score = 0, cross = 0, midj = 0, midState = 0;
+
+  linearPass (A, aStart, M, B, bStart, N, X0, midi, p);
+
+  if (X1 < 0)
+  {
+    X1 = maxState (p->prevRow[N]);
+  }
+
+  if (X1 == 0)
+  {
+    score = p->prevRow[N].sub_score;
+  }
+  else if (X1 == 1)
+  {
+    score = p->prevRow[N].del_score;
+  }
+  else
+  {
+    score = p->prevRow[N].ins_score;
+  }
+
+  cross = p->prevCross[(3 * N) + X1];
+  midj = cross / 4;
+  midState = cross % 4;
+
+    // top half ends where the bottom half starts
+
+  linearDiff (A, aStart, midi, B, bStart, midj, X0, midState, p, theS1, theS2);
+  linearDiff (A, aStart + midi, M - midi, B, bStart + midj, N - midj,
+              midState, X1, p, theS1, theS2);
+
+  return score;
+
+} // end linearDiff function
+
+  // linearAlign function:
+  // the linear space alignment of S1 and S2, theS1 / theS2 get the
+  // aligned sequences, left to right
+  // returns the optimal score
+
+int linearAlign (string &S1, string &S2, scoreScheme &scoring, int g, int h,
+                  vector <char> &theS1, vector <char> &theS2)
+{
+  int n = S1.size ();
+  int m = S2.size ();
+
+  theS1.clear ();
+  theS2.clear ();
+  theS1.reserve (n + m);
+  theS2.reserve (n + m);
+
+  return scoreDispatch (scoring, [&] (auto sub)
+  {
+    linearParams <decltype (sub)> p;
+
+    p.sub = sub;
+    p.h = h;
+    p.g = g;
+
+    p.prevRow.resize (m + 1);
+    p.curRow.resize (m + 1);
+    p.prevCross.resize (3 * (m + 1));
+    p.curCross.resize (3 * (m + 1));
+
+    return linearDiff (S1, 0, n, S2, 0, m, 0, -1, &p, &theS1, &theS2);
+  });
+
+} // end linearAlign function
+
+  // alignLinear function:
+  // alignPair (the CIGAR one, cigar.h) for global alignment in
+  // linear space, for the batch pairs too big for the table
+  // returns the optimal score (also in result.score)
+
+int alignLinear (string &S1, string &S2, scoreScheme &scoring, int g, int h,
+                  alignResult &result)
+{
+  vector <char> theS1;
+  vector <char> theS2;
+  int i = S1.size ();
+  int j = S2.size ();
+
+  result.score = linearAlign (S1, S2, scoring, g, h, theS1, theS2);
+
+  cigarPath path = cigarStart (S1, S2, result, i, j);
+
+    // the columns to the path last first, as tracePath does
+
+  for (int c = (int) theS1.size () - 1; c >= 0; c--)
+  {
+    int state = (theS2[c] == '-') ? 1 : (theS1[c] == '-') ? 2 : 0;
+
+    path.step (state, i, j);
+    i = i - (state != 2);
+    j = j - (state != 1);
+  } // end for each column
+
+  cigarFinish (path, result);
+
+  return result.score;
+
+} // end alignLinear function
+
+  // globalScoreLinear function:
+  // only the global score, from one forward pass in two rows
+  // (linearPass without the middle row), O(m) memory
+
+int globalScoreLinear (string &S1, string &S2, scoreScheme &scoring,
+                        int g, int h)
+{
+  int n = S1.size ();
+  int m = S2.size ();
+
+  statsMark ();
+
+  int score = scoreDispatch (scoring, [&] (auto sub)
+  {
+    linearParams <decltype (sub)> p;
+
+    p.sub = sub;
+    p.h = h;
+    p.g = g;
+
+    p.prevRow.resize (m + 1);
+    p.curRow.resize (m + 1);
+
+    linearPass (S1, 0, n, S2, 0, m, 0, n + 1, &p);
+
+    return cellMax (p.prevRow[m]);
+  });
+
+  statsLap (STATS_FILL);
+
+  return score;
+
+} // end globalScoreLinear function
+
+  // runGlobalLinear function - runs the global alignment test
+  // in linear space, same arguments and output as runGlobal
+
+int runGlobalLinear (string S1, string S2, scoreScheme &scoring, int g, int h,
+                int *matchCount, int *mismatchCount, int *gapCount, int *openingGap)
+{
+  int globalScore = 0;
+
+  vector <char> theS1;
+  vector <char> theS2;
+  vector <char> theLink;
+
+  cout << "n: " << S1.size () + 1 << endl;
+  cout << "m: " << S2.size () + 1 << endl;
+
+  statsMark ();
+
+  globalScore = linearAlign (S1, S2, scoring, g, h, theS1, theS2);
+
+  statsLap (STATS_FILL);
+
+  theLink = buildLink (theS1, theS2);
+
+  tallyAlignment (theS1, theS2, matchCount, mismatchCount,
+                  gapCount, openingGap);
+
+  printAlignment (theS1, theLink, theS2);
+
+  return globalScore;
+
+} // end function runGlobalLinear
+
+#endif
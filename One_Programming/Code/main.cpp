@@ -11,1148 +11,382 @@
 #include <fstream>
 #include <vector>
 #include <iomanip>
+#include "alignCore.h"
+#include "linearSpace.h"
+#include "stripedLocal.h"
+#include "wavefront.h"
+#include "pairAlign.h"
+#include "banded.h"
+#include "batch.h"
+#include "sweep.h"
+#include "topLocal.h"
+#include "myersEdit.h"
+#include "checkpoint.h"
+#include "planner.h"
+#include "anchored.h"
+#include "statsOnly.h"
+#include "scoring.h"
+#include "runStats.h"
+#include "../../Common/fastaMap.h"
 
 using namespace std;
 
-struct DP_cell
-{
-  int score;
-};
-
-struct ADP_cell
-{
-  int sub_score;
-  int del_score;
-  int ins_score;
-};
-
-  // cleanString function:
-  // removes trailing whitespace from a string
-
-string cleanString (string line)
-{
-
-  while (line.back() == ' ')
-  {
-    line.pop_back ();
-  } // end remove any trailing spaces
-
-  return line;
-
-} // end cleanString function
-
-  // reverseString
-
-string reverseString (string theString)
-{
-  char holdChar;
-  int i = 0;
-  int j = theString.length () - 1;
-
-  while (i < j)
-  {
-    holdChar = theString[i];
-    theString[i] = theString[j];
-    theString[j] = holdChar;
-
-    i++;
-    j--;
-
-  } // end swap chars
-
-  return theString;
-
-} // end reverseString function
-
-// reverseString
-
-vector <char> reverseVector (vector <char> theVector)
-{
-char holdChar;
-int i = 0;
-int j = theVector.size () - 1;
-
-while (i < j)
-{
-  holdChar = theVector[i];
-  theVector[i] = theVector[j];
-  theVector[j] = holdChar;
-
-  i++;
-  j--;
-
-} // end swap chars
-
-return theVector;
-
-} // end reverseVector function
-
-  // S function: (calculate a match score for S1 and S2)
-
-int S (char S1, char S2, int match, int mismatch)
-{
-  //int match = 1;
-  //int mismatch = -2;
-
-  if (S1 == S2)
-  {
-    return match;
-  } // end if match, return value assigned to "match"
-  else
-  {
-    return mismatch;
-  } // end else, return the mismatch value
-
-} // end S function
-
   // runGlobal function - runs the global alignment test
 
 /////
-int runGlobal (string S1, string S2, int match, int mismatch, int g, int h,
-                int *matchCount, int *mismatchCount, int *gapCount, int *openingGap)
+int runGlobal (string S1, string S2, scoreScheme &scoring, int g, int h,
+                int *matchCount, int *mismatchCount, int *gapCount, int *openingGap,
+                int threads)
 {
-  // We need a matrix:
-
-  int i = 0, j = 0, maxI = 0, maxJ = 0;
   int m = 0, n = 0;
-  int a = 0, b = 0;
-  int max = 0, subs = 0, del = 0, ins = 0;
-  int maxInd = 0, lastPos, localMax = 0;
   int globalScore;
 
-  vector <char> theS1;
-  vector <char> theS2;
-  vector <char> theLink;
-
-    // m and n need to be the size of the strings + 1
-    // since the zeroeth row and column are used to
-    // hold the initial scores:
-
-  n = S1.size() + 1;
-  m = S2.size() + 1;
-  cout << "n: " << n << endl;
-  cout << "m: " << m << endl;
-
-    // create a table of DP_cell's, n x m size
-    // Key:
-    // y = n = i = a = row
-    // x = m = j = b = column
-
-  // myT = (struct ADP_cell **) malloc (sizeof(ADP_cell *)*n));
-  //struct ADP_cell myTable[n][m];
-  //struct myStruct **myArray = (struct ADP_cell **) malloc (sizeof(ADP_cell *) * n);
-  //struct myStruct myArray[n];
-
-  //struct ADP_cell **myTable = new struct ADP_cell * [m];
-  struct ADP_cell **myTable = (struct ADP_cell **) malloc (sizeof(ADP_cell *) * n);
-
-  for (int z = 0; z < n; z++)
-  {
-    myTable[z] = new struct ADP_cell [m];
-    //myTable[z] = (struct ADP_cell **) malloc (sizeof(ADP_cell *) [m]);
-  } // end fill up the rows
-cout << "Matrix created successfully" << endl;
-  //struct ADP_cell **myTable = new struct ADP_cell * [n];
-  /*
-  for (a = 0; a < m; a++)
-  {
-    myTable[a] = new struct ADP_cell [m];
-  } // end initialize matrix
-  */
-
-    // initialize scores in the table:
-    // T(0,0): S(0,0) = 0, D(0,0) = 0, I(0,0) = 0
-    // for (i=1 to m):
-    //  T(i, 0): S(i,0) = -infinity, D(i,0) = h + i * g, I(i,0) = -infinity
-    // for (j = 1 to n):
-    //  T(0,j): S(0,j) = -infinity, D(0,j) = -infinity, I(0,j) = h + j * g
-
-    // initialize everything to zero:
-
-  for (a = 0; a < n; a++)
-  {
-    for (b = 0; b < m; b++)
-    {
-      myTable[a][b].sub_score = 0;
-      myTable[a][b].del_score = 0;
-      myTable[a][b].ins_score = 0;
-    } // end inner loop (columns)
-  } // end outer loop (rows)
-cout << "All scores initialized to zero successfully" << endl;
-
-    // initialize the zeroeth row and column
-    // I can't initialize to negative infinity so,
-    // I'm using max negative integer value -32,767 instead
-
-  for (i = 1; i < n; i++)
-  {
-    myTable[i][0].sub_score = -32767;
-    myTable[i][0].del_score = (h + (i * g) );
-    myTable[i][0].ins_score = -32767;
-
-  } // end initialize column i to zero
-
-  for (j = 1; j < m; j++)
-  {
-    myTable[0][j].sub_score = -32767;
-    myTable[0][j].del_score = -32767;
-    myTable[0][j].ins_score = (h + (j * g) );
-
-  } // end initialize row j to j * g
-cout << "Row / Column initialization successful" << endl;
-    // calculate all scores:
-    // Since row 0 and column 0 contain initializing scores,
-    // we need to begin at row 1 and column 1:
-
-    // For local algorithm, we need to know the position of the highest score
-    // so, track scores as they are calculated, tracking the position of the
-    // highest score and use that to begin the backtrace
-
-  i = 1;
-  j = 1;
-
-  for (i = 1; i < n; i++)
-  {
-    for (j = 1; j < m; j++)
-    {
-        // calculate scores:
-
-        // substition:
-
-      subs = ((myTable[i-1][j-1].sub_score));
-      //cout << "i: " << i << " ,j:" << j << " :S1[i-1]: " << S1[i-1] << " :S2[j-1]: " << S2[j-1] << endl;
-      max = subs;
-
-        // calculate deletion score:
-
-      del = ((myTable[i-1][j-1].del_score));
-
-        // if del is greater than max, make it new max
-
-      if (del > max)
-      {
-        max = del;
-
-      } // end if del is greater than max, make it new max
-
-        // calculate insertion score:
-
-      ins = ((myTable[i-1][j-1].ins_score));
-
-      // if ins is greater than max, make it new max
-
-      if (ins > max)
-      {
-        max = ins;
-
-      } // end if ins is greater than max, make it new max
-
-      myTable[i][j].sub_score = max + ( S(S1[i-1], S2[j-1], match, mismatch) );
-
-      // Deletion
-
-      subs = myTable[i-1][j].sub_score + h + g;
-
-      max = subs;
-
-      del = myTable[i-1][j].del_score + g;
-
-      if (del > max)
-      {
-        max = del;
-      }
-
-      ins = myTable[i-1][j].ins_score + h + g;
-
-      if (ins > max)
-      {
-        max = ins;
-      }
-
-      myTable[i][j].del_score = max;
-
-      // Insertion
-
-      subs = myTable[i][j-1].sub_score + h + g;
-
-      max = subs;
-
-      del = myTable[i][j-1].del_score + h + g;
-
-      if (del > max)
-      {
-        max = del;
-      }
-
-      ins = myTable[i][j-1].ins_score + g;
-
-      if (ins > max)
-      {
-        max = ins;
-      }
-
-      myTable[i][j].ins_score = max;
-
-    } // end inner loop
-
-  } // end outer loop
-
-  // end calculate scores
-
-cout << "Scores successfully calculated" << endl;
-    // backtrace:
-    // use three vectors to hold characters:
-    // theS1 will hold the characters for S1,
-    // theS2 will hold the characters for S2,
-    // theLink will hold the "|" character or " "
-    // to indicate yes or no for match between them
-
-    // print the size of the table:
-
-  cout << "matrix size: " << sizeof(myTable) << endl;
-
-    // For Global search, start at the last position in the table:
-
-  i = n - 1;
-  j = m - 1;
-
-    // print out the max score, find the highest
-    // score in the last cell:
-
-    subs = myTable[i][j].sub_score;
-    max = subs;
-
-    del = myTable[i][j].del_score;
-    if (del > max)
-    {
-      max = del;
-    }
-
-    ins = myTable[i][j].ins_score;
-    if (ins > max)
-    {
-      max = ins;
-    }
-
-    //cout << "Global Score: " << max << endl;
-    globalScore = max;
-
-    // now run backtrace until max == 0
-
-  //cout << "backtrace: " << endl;
-
-  while ( max != 0 )
-  //while ( (i > -1) && (j > -1) )
-  {
-      // check substitution:
-
-    subs = myTable[i-1][j-1].sub_score;
-    localMax = subs;
-    del = myTable[i-1][j-1].del_score;
-    if (del > localMax)
-    {
-      localMax = del;
-    }
-    ins = myTable[i-1][j-1].ins_score;
-    if (ins > localMax)
-    {
-      localMax = ins;
-    }
-    //cout << "subs: " << subs;
-    max = localMax;
-    // the maxInd is a key to let me know which path has the highest score
-    // 0 = diagonal or substitution,
-    // 1 = up or deletion
-    // 2 = left or insertion
-    maxInd = 0;
-
-    // check deletion:
-
-    subs = myTable[i-1][j].sub_score;
-    localMax = subs;
-    del = myTable[i-1][j].del_score;
-    if (del > localMax)
-    {
-      localMax = del;
-    }
-    ins = myTable[i-1][j].ins_score;
-    if (ins > localMax)
-    {
-      localMax = ins;
-    }
-    //cout << "subs: " << subs;
-    max = localMax;
-
-    //cout << "   - del: " << del;
-    if (localMax > max)
-    {
-      max = localMax;
-      maxInd = 1;
-
-    } // end if del > max, update max
-
-    // check insertion:
-
-    subs = myTable[i][j-1].sub_score;
-    localMax = subs;
-    del = myTable[i][j-1].del_score;
-    if (del > localMax)
-    {
-      localMax = del;
-    }
-    ins = myTable[i][j-1].ins_score;
-    if (ins > localMax)
-    {
-      localMax = ins;
-    }
-    //cout << "subs: " << subs;
-
-    //cout << "   - ins: " << ins << endl;
-    if (localMax > max)
-    {
-      max = localMax;
-      maxInd = 2;
-
-    } // end if del > max, update max
-
-    // update the vectors appropriately:
-    //
-
-    if (maxInd == 0)
-    {
-      theS1.push_back(S1[i-1]);
-      theS2.push_back(S2[j-1]);
-      if (S1[i-1] == S2[j-1])
-      {
-        theLink.push_back ('|');
-        *matchCount = *matchCount + 1;
-      } // end if match
-      else
-      {
-        theLink.push_back (' ');
-        *mismatchCount = *mismatchCount + 1;
-      } // end else, no match
-
-        // since this is a substitution,
-        // if our last move was a gap, this is
-        // an opening gap:
-
-      if ((lastPos == 1) || (lastPos == 2) )
-      {
-        *openingGap = *openingGap + 1;
-      } // end if our last move was a gap
-
-      i--;
-      j--;
-
-    } // end if substitution
-
-    if (maxInd == 1)
-    {
-      theS1.push_back(S1[i-1]);
-      theS2.push_back('-');
-
-      theLink.push_back (' ');
-      *gapCount = *gapCount + 1;
-
-      i--;
-
-    } // end if deletion
-
-    if (maxInd == 2)
-    {
-      theS1.push_back('-');
-      theS2.push_back(S2[j-1]);
-
-      theLink.push_back (' ');
-
-      j--;
-
-    } // end if insertion
-
-    lastPos = maxInd;
-
-  } // end while loop to backtrace
-
-    // reverse the strings:
-
-  theS1 = reverseVector (theS1);
-  theLink = reverseVector (theLink);
-  theS2 = reverseVector (theS2);
-  //cout << "theS1: " << theS1.size () << " - theLink: " << theLink.size() << " - theS2: " << theS2.size() << endl;
-
-/////
-
-    // Print out results:
-
-  int total = theLink.size ();
-  int S1Index = 0, S2Index = 0, linkIndex = 0;
-  int charCount = 0;
-  int rowSize = 60, rowStart = 0;
-
-  while (linkIndex < total)
-  {
-    if ((total - linkIndex) < 60)
-    {
-      rowSize = total - linkIndex;
-    }
-
-    ////////////////////////////////////////////
-      // S1
-    cout << "S1 " << setw(5) << S1Index << " ";
-    for (rowStart = 0; rowStart < rowSize; rowStart++)
-    {
-      if (theS1[linkIndex + rowStart] != '-')
-      {
-        S1Index++;
-      } // end increment S1Index
-
-      cout << theS1[linkIndex + rowStart];
-    } // end for loop to print 60 (or fewer) characters from theS1
-
-    cout << setw(5) << S1Index << endl;
-    S1Index++;
-    ////////////////////////////////////////////
-    cout << setw(10);
-    for (rowStart = 0; rowStart < rowSize; rowStart++)
-    {
-      cout << theLink[linkIndex + rowStart];
-
-    } // end for loop to print 60 (or fewer) characters from theS1
-
-    cout << endl;
-    ////////////////////////////////////////////
-    cout << "S2 " << setw(5) << S2Index << " ";
-    for (rowStart = 0; rowStart < rowSize; rowStart++)
-    {
-      if (theS2[linkIndex + rowStart] != '-')
-      {
-        S2Index++;
-      } // end increment S2Index
-
-      cout << theS2[linkIndex + rowStart];
-
-    } // end for loop to print 60 (or fewer) characters from theS1
-
-    cout << setw(5) << S2Index << endl << endl;
-    S2Index++;
-    ////////////////////////////////////////////
-
-    linkIndex += rowSize;
-
-  } // end while to print all characters
-/////
-
-  /*
-    // Print out results:
-
-  a = 0;
-
-  while (theS1[a])
-  {
-    cout << theS1[a];
-    a++;
-
-  } // end print out theS1
-
-  cout << endl;
-
-  a = 0;
-
-  while (theLink[a])
-  {
-    cout << theLink[a];
-    a++;
-
-  } // end print out theLink
-
-  cout << endl;
-
-  a = 0;
-cout << theS2[a];
-a++;
-  while (theS2[a])
-  {
-    cout << theS2[a];
-    a++;
-
-  } // end print out theS2
-
-  cout << endl;
-  */
-
-  /*
-    // print the matrix
-
-  for (int a = 0; a < n; a++)
-  {
-    for (int b = 0; b < m; b++)
-    {
-      cout << myTable[a][b].score << ",";
-    }
-    cout << endl;
-
-  } // end for loop to print the matrix
-  */
-
-  return globalScore;
-
-} // end function runGlobal
-/////
-
-
-  // runLocal function - runs the local alignment test
-
-int runLocal (string S1, string S2, int match, int mismatch, int g, int h,
-                int *matchCount, int *mismatchCount, int *gapCount, int *openingGap)
-{
-  // We need a matrix:
-
-  int i = 0, j = 0, maxI = 0, maxJ = 0, highScore = 0;
-  int m = 0, n = 0;
-  int a = 0, b = 0;
-  int max = 0, subs = 0, del = 0, ins = 0;
-  int maxInd = 0, lastPos, localMax = 0;
-
-  vector <char> theS1;
-  vector <char> theS2;
-  vector <char> theLink;
+  alignResult theResult;
 
     // m and n need to be the size of the strings + 1
     // since the zeroeth row and column are used to
     // hold the initial scores:
 
-  n = S1.size() + 1;
-  m = S2.size() + 1;
-  cout << "n: " << n << endl;
-  cout << "m: " << m << endl;
-
-    // create a table of DP_cell's, n x m size
-    // Key:
-    // y = n = i = a = row
-    // x = m = j = b = column
-
-  //struct ADP_cell myTable[n][m];
-  struct ADP_cell **myTable = new struct ADP_cell * [n];
-
-  for (int z = 0; z < n; z++)
-  {
-    myTable[z] = new struct ADP_cell [m];
-  } // end fill up the rows
-
-    // initialize scores in the table:
-    // T(0,0): S(0,0) = 0, D(0,0) = 0, I(0,0) = 0
-    // for (i=1 to m):
-    //  T(i, 0): S(i,0) = -infinity, D(i,0) = h + i * g, I(i,0) = -infinity
-    // for (j = 1 to n):
-    //  T(0,j): S(0,j) = -infinity, D(0,j) = -infinity, I(0,j) = h + j * g
-
-    // initialize everything to zero:
-
-  for (a = 0; a < n; a++)
-  {
-    for (b = 0; b < m; b++)
-    {
-      myTable[a][b].sub_score = 0;
-      myTable[a][b].del_score = 0;
-      myTable[a][b].ins_score = 0;
-    } // end inner loop (columns)
-  } // end outer loop (rows)
-
-    // initialize the zeroeth row and column
-    // I can't initialize to negative infinity so,
-    // I'm using max negative integer value -32,767 instead
-
-  for (i = 1; i < n; i++)
-  {
-    /*
-    myTable[i][0].sub_score = -32767;
-    myTable[i][0].del_score = (h + (i * g) );
-    myTable[i][0].ins_score = -32767;
-    */
-    myTable[i][0].sub_score = 0;
-    myTable[i][0].del_score = 0;
-    myTable[i][0].ins_score = 0;
-
-  } // end initialize column i to zero
-
-  for (j = 1; j < m; j++)
-  {
-    /*
-    myTable[0][j].sub_score = -32767;
-    myTable[0][j].del_score = -32767;
-    myTable[0][j].ins_score = (h + (i * g) );
-    */
-    myTable[0][j].sub_score = 0;
-    myTable[0][j].del_score = 0;
-    myTable[0][j].ins_score = 0;
-  } // end initialize row j to j * g
-
-
-    // calculate all scores:
-    // Since row 0 and column 0 contain initializing scores,
-    // we need to begin at row 1 and column 1:
-
-    // For local algorithm, we need to know the position of the highest score
-    // so, track scores as they are calculated, tracking the position of the
-    // highest score and use that to begin the backtrace
-
-  i = 1;
-  j = 1;
-
-  for (i = 1; i < n; i++)
-  {
-    for (j = 1; j < m; j++)
-    {
-        // calculate scores:
-
-        // substition:
-
-      subs = ((myTable[i-1][j-1].sub_score));
-      //cout << "i: " << i << " ,j:" << j << " :S1[i-1]: " << S1[i-1] << " :S2[j-1]: " << S2[j-1] << endl;
-      max = subs;
-
-        // calculate deletion score:
-
-      del = ((myTable[i-1][j-1].del_score));
-
-        // if del is greater than max, make it new max
-
-      if (del > max)
-      {
-        max = del;
-
-      } // end if del is greater than max, make it new max
-
-        // calculate insertion score:
-
-      ins = ((myTable[i-1][j-1].ins_score));
-
-
-      // if ins is greater than max, make it new max
-
-      if (ins > max)
-      {
-        max = ins;
-
-      } // end if ins is greater than max, make it new max
-
-      //myTable[i][j].sub_score = max + ( S(S1[i-1], S2[j-1], match, mismatch) );
-
-      max += ( S(S1[i-1], S2[j-1], match, mismatch) );
-
-      if (max < 0)
-      {
-        max = 0;
-      } // end no negative scores
-
-      myTable[i][j].sub_score = max;
-
-
-      // Deletion
-
-      subs = myTable[i-1][j].sub_score + h + g;
-
-      max = subs;
-
-      del = myTable[i-1][j].del_score + g;
-
-      if (del > max)
-      {
-        max = del;
-      }
-
-      ins = myTable[i-1][j].ins_score + h + g;
-
-      if (ins > max)
-      {
-        max = ins;
-      }
-
-      if (max < 0)
-      {
-        max = 0;
-      } // end no negative scores
-
-      myTable[i][j].del_score = max;
-
-      // Insertion
+  n = S1.size() + 1;
+  m = S2.size() + 1;
+  cout << "n: " << n << endl;
+  cout << "m: " << m << endl;
 
-      subs = myTable[i][j-1].sub_score + h + g;
+    // the table only keeps a 4 bit traceback code per cell
+    // (traceback.h), the scores are filled two rows at a time,
+    // on "threads" threads if more than one (wavefront.h)
+    // T(0,0): S(0,0) = 0, D(0,0) = 0, I(0,0) = 0
+    // for (i=1 to m):
+    //  T(i, 0): S(i,0) = -infinity, D(i,0) = h + i * g, I(i,0) = -infinity
+    // for (j = 1 to n):
+    //  T(0,j): S(0,j) = -infinity, D(0,j) = -infinity, I(0,j) = h + j * g
+    // I can't initialize to negative infinity so,
+    // I'm using ADP_MINUS_INFINITY (INT_MIN / 4) instead
+    // The backtrace starts at the last cell, in the state with
+    // the highest score there.  A deletion or insertion extends
+    // the gap above / to the left when that scores at least as
+    // well as opening a new gap there.
 
-      max = subs;
+  globalScore = alignPair (S1, S2, scoring, g, h, ALIGN_GLOBAL, threads,
+                           NULL, theResult);
 
-      del = myTable[i][j-1].del_score + h + g;
+  tallyResult (theResult, matchCount, mismatchCount, gapCount, openingGap);
 
-      if (del > max)
-      {
-        max = del;
-      }
+    // Print out results:
 
-      ins = myTable[i][j-1].ins_score + g;
+  printCigarAlignment (S1, S2, theResult);
 
-      if (ins > max)
-      {
-        max = ins;
-      }
+  return globalScore;
 
-      if (max < 0)
-      {
-        max = 0;
-      } // end no negative scores
+} // end function runGlobal
+/////
 
-      myTable[i][j].ins_score = max;
 
-      if (max > highScore)
-      {
-        highScore = max;
-        maxI = i;
-        maxJ = j;
-        //cout << max << " : " << maxI << ", " << maxJ << endl;
-      } // end if we have found a higher score, record its position
+  // runLocal function - runs the local alignment test
 
-    } // end inner loop
+int runLocal (string S1, string S2, scoreScheme &scoring, int g, int h,
+                int *matchCount, int *mismatchCount, int *gapCount, int *openingGap,
+                int threads)
+{
+  int m = 0, n = 0;
+  int highScore = 0;
 
-  } // end outer loop
+  alignResult theResult;
 
-  // end calculate scores
+    // m and n need to be the size of the strings + 1
+    // since the zeroeth row and column are used to
+    // hold the initial scores:
 
+  n = S1.size() + 1;
+  m = S2.size() + 1;
+  cout << "n: " << n << endl;
+  cout << "m: " << m << endl;
 
-  //cout << "highScore: " << highScore << endl;
-  //cout << maxI << ", " << maxJ << endl;
+    // same table as runGlobal, but the zeroeth row and column
+    // are all zero and no score goes below zero
+    // For local algorithm, we need to know the position of the highest score
+    // so, track scores as they are calculated, tracking the position of the
+    // highest score and use that to begin the backtrace, which runs
+    // back to where the scores before it are 0
 
+  highScore = alignPair (S1, S2, scoring, g, h, ALIGN_LOCAL, threads,
+                         NULL, theResult);
 
-    // backtrace:
-    // use three vectors to hold characters:
-    // theS1 will hold the characters for S1,
-    // theS2 will hold the characters for S2,
-    // theLink will hold the "|" character or " "
-    // to indicate yes or no for match between them
+  tallyResult (theResult, matchCount, mismatchCount, gapCount, openingGap);
 
+    // Print out results:
 
-    // For local search, start at the position of the highest score:
+  printCigarAlignment (S1, S2, theResult);
 
-  i = maxI;
-  j = maxJ;
+  return highScore;
 
-  // If there is an offset, fill the empty spaces:
+} // end function runLocal
 
-  if (maxI > maxJ)
-  {
-    int offset = maxI - maxJ;
-    int theI = n - 2, theJ = m - 2;
+  // runSemiGlobal function - all of S1 (the read) against the piece of
+  // S2 (the reference window) it fits best, the gaps before and after
+  // that piece are free
 
-    for (int o = 0; o < offset; o++)
-    {
-      theS1.push_back ('-');
-      theS2.push_back (S2[theJ]);
-      theJ--;
-    } // end do fill of I
+int runSemiGlobal (string S1, string S2, scoreScheme &scoring, int g, int h,
+                    int *matchCount, int *mismatchCount, int *gapCount,
+                    int *openingGap, int threads)
+{
+  int semiScore = 0;
 
-  } // end if maxI > maxJ
+  alignResult theResult;
 
-  if (maxJ > maxI)
-  {
-    int offset = maxJ - maxI;
-    int theI = n - 2, theJ = m - 2;
+  cout << "n: " << S1.size () + 1 << endl;
+  cout << "m: " << S2.size () + 1 << endl;
 
-    for (int o = 0; o < offset; o++)
-    {
-      theS1.push_back (S1[theI]);
-      theS2.push_back ('-');
-      theI--;
-    } // end do fill of J
+    // same table as runGlobal, but the zeroeth row is all zero
+    // (S1 can start anywhere in S2) and the backtrace starts at the
+    // best cell of the last row (S1 can end anywhere in S2), so the
+    // counts are only over the piece of S2 that S1 is aligned to
 
-  } // end if maxI < maxJ
+  semiScore = alignPair (S1, S2, scoring, g, h, ALIGN_SEMIGLOBAL, threads,
+                         NULL, theResult);
 
-    // now run normal backtrace until either i, or j == 0
+  cout << "S2 positions " << theResult.startJ + 1 << " - ";
+  cout << theResult.endJ << endl << endl;
 
-  //cout << "backtrace: " << endl;
+  tallyResult (theResult, matchCount, mismatchCount, gapCount, openingGap);
 
-  while ( max != 0 )
-  //while ( (i > -1) && (j > -1) )
-  {
-      // check substitution:
+    // Print out results:
 
-    subs = myTable[i-1][j-1].sub_score;
-    localMax = subs;
-    del = myTable[i-1][j-1].del_score;
-    if (del > localMax)
-    {
-      localMax = del;
-    }
-    ins = myTable[i-1][j-1].ins_score;
-    if (ins > localMax)
-    {
-      localMax = ins;
-    }
-    //cout << "subs: " << subs;
-    max = localMax;
-    // the maxInd is a key to let me know which path has the highest score
-    // 0 = diagonal or substitution,
-    // 1 = up or deletion
-    // 2 = left or insertion
-    maxInd = 0;
-
-    // check deletion:
-
-    subs = myTable[i-1][j].sub_score;
-    localMax = subs;
-    del = myTable[i-1][j].del_score;
-    if (del > localMax)
-    {
-      localMax = del;
-    }
-    ins = myTable[i-1][j].ins_score;
-    if (ins > localMax)
-    {
-      localMax = ins;
-    }
-    //cout << "subs: " << subs;
-    //max = localMax;
+  printCigarAlignment (S1, S2, theResult);
 
-    //cout << "   - del: " << del;
-    if (localMax > max)
-    {
-      max = localMax;
-      maxInd = 1;
+  return semiScore;
 
-    } // end if del > max, update max
+} // end function runSemiGlobal
 
-    // check insertion:
+  // runGlobalEdit function - unit cost global alignment (myersEdit.h),
+  // every mismatch and every gap character costs 1
+  // scoreOnly: only the edit distance, no alignment
 
-    subs = myTable[i][j-1].sub_score;
-    localMax = subs;
-    del = myTable[i][j-1].del_score;
-    if (del > localMax)
-    {
-      localMax = del;
-    }
-    ins = myTable[i][j-1].ins_score;
-    if (ins > localMax)
-    {
-      localMax = ins;
-    }
-    //cout << "subs: " << subs;
+int runGlobalEdit (string S1, string S2, bool scoreOnly,
+                    int *matchCount, int *mismatchCount, int *gapCount,
+                    int *openingGap)
+{
+  vector <char> theS1;
+  vector <char> theS2;
+  vector <char> theLink;
+  dpArena arena (true);
+  int distance = 0;
 
-    //cout << "   - ins: " << ins << endl;
-    if (localMax > max)
-    {
-      max = localMax;
-      maxInd = 2;
+  cout << "n: " << S1.size () + 1 << endl;
+  cout << "m: " << S2.size () + 1 << endl;
 
-    } // end if del > max, update max
+  if (scoreOnly)
+  {
+    statsMark ();
+    distance = myersDistance (S1, S2, -1);
+    statsCells ( (long long) S1.size () * S2.size ());
+    statsLap (STATS_FILL);
 
-    // update the vectors appropriately:
-    //
+    return distance;
+  } // end if only the distance
 
-    if (maxInd == 0)
-    {
-      theS1.push_back(S1[i-1]);
-      theS2.push_back(S2[j-1]);
-      if (S1[i-1] == S2[j-1])
-      {
-        theLink.push_back ('|');
-        *matchCount = *matchCount + 1;
-      } // end if match
-      else
-      {
-        theLink.push_back (' ');
-        *mismatchCount = *mismatchCount + 1;
-      } // end else, no match
+  distance = myersAlign (S1, S2, arena, theS1, theS2);
 
-        // since this is a substitution,
-        // if our last move was a gap, this is
-        // an opening gap:
+  if (distance < 0)
+  {
+    cout << "Not enough memory for the table - try --score-only" << endl;
+    return 0;
+  } // end if out of memory
 
-      if ((lastPos == 1) || (lastPos == 2) )
-      {
-        *openingGap = *openingGap + 1;
-      } // end if our last move was a gap
+  theLink = buildLink (theS1, theS2);
 
-      i--;
-      j--;
+  tallyAlignment (theS1, theS2, matchCount, mismatchCount,
+                  gapCount, openingGap);
 
-    } // end if substitution
+    // Print out results:
 
-    if (maxInd == 1)
-    {
-      theS1.push_back(S1[i-1]);
-      theS2.push_back('-');
+  printAlignment (theS1, theLink, theS2);
 
-      theLink.push_back (' ');
-      *gapCount = *gapCount + 1;
+  return distance;
 
-      i--;
+} // end function runGlobalEdit
 
-    } // end if deletion
+  // runCheckpoint function - global, local or semi-global with the
+  // checkpointed backtrace (checkpoint.h): only every k-th row of
+  // scores is kept, each band is filled again for the backtrace
 
-    if (maxInd == 2)
-    {
-      theS1.push_back('-');
-      theS2.push_back(S2[j-1]);
+int runCheckpoint (string S1, string S2, scoreScheme &scoring, int g, int h,
+                    int mode, int k, int *matchCount, int *mismatchCount,
+                    int *gapCount, int *openingGap)
+{
+  int n = S1.size () + 1;
+  int m = S2.size () + 1;
+  int score = 0;
 
-      theLink.push_back (' ');
+  alignResult theResult;
+  dpArena arena (true);
 
-      j--;
+  cout << "n: " << n << endl;
+  cout << "m: " << m << endl;
 
-    } // end if insertion
+  if (k <= 0)
+  {
+    k = checkpointRows (n);
+  }
 
-    lastPos = maxInd;
+  cout << "checkpoint every " << k << " rows, about ";
+  cout << checkpointBytes (n, m, k, h) / (1024 * 1024) << " MB" << endl << endl;
 
-  } // end while loop to backtrace
+  score = alignCheckpoint (S1, S2, scoring, g, h, mode, k, arena,
+                           theResult);
 
-    // fill in remainder:
-  if (i == 0)
+  if (mode == ALIGN_SEMIGLOBAL)
   {
-    while (j > -1)
-    {
-      theS1.push_back ('-');
-      theS2.push_back (S2[j]);
-      j--;
-    } // end fill in remaining S1's with -
+    cout << "S2 positions " << theResult.startJ + 1 << " - ";
+    cout << theResult.endJ << endl << endl;
+  } // end if semi-global
 
-  } // end if S1 reached zero first
+  tallyResult (theResult, matchCount, mismatchCount, gapCount, openingGap);
 
-  if (j == 0)
-  {
-    while (i > -1)
-    {
-      theS1.push_back (S1[i]);
-      theS2.push_back ('-');
-      j--;
-    } // end fill in remaining S2's with -
+    // Print out results:
 
-  } // end if S2 reached zero first
+  printCigarAlignment (S1, S2, theResult);
 
-    // reverse the strings:
+  return score;
 
-  theS1 = reverseVector (theS1);
-  theLink = reverseVector (theLink);
-  theS2 = reverseVector (theS2);
+} // end function runCheckpoint
 
-  //cout << "theS1: " << theS1.size () << " - theLink: " << theLink.size() << " - theS2: " << theS2.size() << endl;
+  // runGlobalAnchored function - global through the chained MUMs of
+  // S1 and S2 (anchored.h), the DP only in the gaps between them
 
-/////
+int runGlobalAnchored (string S1, string S2, scoreScheme &scoring, int g,
+                        int h, int minLength, size_t budget,
+                        int *matchCount, int *mismatchCount,
+                        int *gapCount, int *openingGap)
+{
+  int score = 0;
 
-    // Print out results:
+  alignResult theResult;
+  anchorSummary theSummary;
+  dpArena arena (true);
 
-  int total = theLink.size ();
-  int S1Index = 0, S2Index = 0, linkIndex = 0;
-  int charCount = 0;
-  int rowSize = 60, rowStart = 0;
+  cout << "n: " << S1.size () + 1 << endl;
+  cout << "m: " << S2.size () + 1 << endl;
 
-  while (linkIndex < total)
+  if (minLength <= 0)
   {
-    if ((total - linkIndex) < 60)
-    {
-      rowSize = total - linkIndex;
-    }
+    minLength = ANCHOR_MIN_LENGTH;
+  }
 
-    ////////////////////////////////////////////
-      // S1
-    cout << "S1 " << setw(5) << S1Index << " ";
-    for (rowStart = 0; rowStart < rowSize; rowStart++)
-    {
-      if (theS1[linkIndex + rowStart] != '-')
-      {
-        S1Index++;
-      } // end increment S1Index
+  score = alignAnchored (S1, S2, scoring, g, h, minLength, budget, arena,
+                         theResult, &theSummary);
 
-      cout << theS1[linkIndex + rowStart];
-    } // end for loop to print 60 (or fewer) characters from theS1
+  cout << "MUMs of " << minLength << " or more: " << theSummary.mums;
+  cout << ", " << theSummary.anchors << " chained, " << theSummary.anchored;
+  cout << " bases anchored (";
+  cout << ( (S1.size () > 0) ? 100.0 * theSummary.anchored / S1.size () : 0.0);
+  cout << "% of S1)" << endl;
+  cout << "largest gap: " << theSummary.widestI << " x ";
+  cout << theSummary.widestJ << endl << endl;
 
-    cout << setw(5) << S1Index << endl;
-    S1Index++;
-    ////////////////////////////////////////////
-    cout << setw(10);
-    for (rowStart = 0; rowStart < rowSize; rowStart++)
-    {
-      cout << theLink[linkIndex + rowStart];
+  tallyResult (theResult, matchCount, mismatchCount, gapCount, openingGap);
 
-    } // end for loop to print 60 (or fewer) characters from theS1
+    // Print out results:
 
-    cout << endl;
-    ////////////////////////////////////////////
-    cout << "S2 " << setw(5) << S2Index << " ";
-    for (rowStart = 0; rowStart < rowSize; rowStart++)
-    {
-      if (theS2[linkIndex + rowStart] != '-')
-      {
-        S2Index++;
-      } // end increment S2Index
+  printCigarAlignment (S1, S2, theResult);
 
-      cout << theS2[linkIndex + rowStart];
+  return score;
 
-    } // end for loop to print 60 (or fewer) characters from theS1
+} // end function runGlobalAnchored
 
-    cout << setw(5) << S2Index << endl << endl;
-    S2Index++;
-    ////////////////////////////////////////////
+  // runStatsOnly function - global, local or semi-global down to the
+  // score and the counts (statsOnly.h): two rows, no backtrace, so
+  // there is no alignment to print
 
-    linkIndex += rowSize;
+int runStatsOnly (string S1, string S2, scoreScheme &scoring, int g, int h,
+                   int mode, int *matchCount, int *mismatchCount,
+                   int *gapCount, int *openingGap)
+{
+  int score = 0;
 
-  } // end while to print all characters
-/////
+  alignResult theResult;
 
-  /*
-    // Print out results:
+  cout << "n: " << S1.size () + 1 << endl;
+  cout << "m: " << S2.size () + 1 << endl << endl;
 
-  a = 0;
+  score = alignStatsOnly (S1, S2, scoring, g, h, mode, theResult);
 
-  while (theS1[a])
+  if (mode == ALIGN_SEMIGLOBAL)
   {
-    cout << theS1[a];
-    a++;
+    cout << "S2 positions " << theResult.startJ + 1 << " - ";
+    cout << theResult.endJ << endl << endl;
+  } // end if semi-global
+  else if (mode == ALIGN_LOCAL)
+  {
+    cout << "S1 positions " << theResult.startI + 1 << " - ";
+    cout << theResult.endI << ", S2 positions " << theResult.startJ + 1;
+    cout << " - " << theResult.endJ << endl << endl;
+  } // end else if local
 
-  } // end print out theS1
+  tallyResult (theResult, matchCount, mismatchCount, gapCount, openingGap);
 
-  cout << endl;
+  return score;
 
-  a = 0;
+} // end function runStatsOnly
 
-  while (theLink[a])
-  {
-    cout << theLink[a];
-    a++;
+  // runLocalTop function - the "top" best local alignments that
+  // share no cell (topLocal.h), each printed with its counts
+  // the counts passed back are those of the best one
+
+int runLocalTop (string S1, string S2, scoreScheme &scoring, int g, int h,
+                  int top, int *matchCount, int *mismatchCount,
+                  int *gapCount, int *openingGap)
+{
+  vector <localHit> hits;
+  vector <char> theLink;
+  dpArena arena (true);
 
-  } // end print out theLink
+  cout << "n: " << S1.size () + 1 << endl;
+  cout << "m: " << S2.size () + 1 << endl;
 
-  cout << endl;
+  if (topLocal (S1, S2, scoring, g, h, top, arena, hits) < 0)
+  {
+    cout << "Not enough memory for the table - try --score-only" << endl;
+    return 0;
+  } // end if out of memory
 
-  a = 0;
-cout << theS2[a];
-a++;
-  while (theS2[a])
+  for (size_t r = 0; r < hits.size (); r++)
   {
-    cout << theS2[a];
-    a++;
+    int matches = 0, mismatches = 0, gaps = 0, openings = 0;
 
-  } // end print out theS2
+    cout << endl << "Alignment " << r + 1 << ": score " << hits[r].score;
+    cout << ", S1 " << hits[r].startI + 1 << " - " << hits[r].endI;
+    cout << ", S2 " << hits[r].startJ + 1 << " - " << hits[r].endJ;
+    cout << endl << endl;
 
-  cout << endl;
-  */
+    theLink = buildLink (hits[r].theS1, hits[r].theS2);
+    printAlignment (hits[r].theS1, theLink, hits[r].theS2);
 
-  /*
-    // print the matrix
+    tallyAlignment (hits[r].theS1, hits[r].theS2, &matches, &mismatches,
+                    &gaps, &openings);
 
-  for (int a = 0; a < n; a++)
-  {
-    for (int b = 0; b < m; b++)
+    cout << "matches: " << matches << ", mismatches: " << mismatches;
+    cout << ", gaps: " << gaps << ", openingGaps: " << openings << endl;
+
+    if (r == 0)
     {
-      cout << myTable[a][b].score << ",";
+      *matchCount = matches;
+      *mismatchCount = mismatches;
+      *gapCount = gaps;
+      *openingGap = openings;
     }
-    cout << endl;
+  } // end for each alignment
 
-  } // end for loop to print the matrix
-  */
+  return hits.empty () ? 0 : hits[0].score;
 
-  return highScore;
+} // end function runLocalTop
 
-} // end function runLocal
+  // readFile function:
+  // reads match, mismatch, g and h from the parameter file, and the
+  // name of the substitution matrix ("matrix" line, scoring.h) if any
 
 void readFile (string inputFile, int *matchVal,
-                int *mismatchVal, int *gVal, int *hVal)
+                int *mismatchVal, int *gVal, int *hVal, string *matrixVal)
 {
   string theLine;
   string match, mismatch, g, h;
@@ -1182,6 +416,13 @@ void readFile (string inputFile, int *matchVal,
     theString.append(theLine, 0,i);
     theVal.append(theLine, i+1,theLine.length());
 
+    if (theString == "matrix")
+    {
+      *matrixVal = cleanString (theVal);
+      theString = "";
+      theVal = "";
+      continue;
+    } // end if the substitution matrix, not a number
 
     theNumericalVal = stoi (theVal);
 
@@ -1222,155 +463,620 @@ int main (int argc, char * argv [])
   int mismatch = 0;
   int h = 0;
   int g = 0;
+  string matrix;
+  scoreScheme scoring;
   int matchCount = 0, mismatchCount = 0, gapCount = 0, openingGap = 0;
-  int globalScore, localScore;
+  int globalScore = 0, localScore = 0, semiScore = 0;
   string whichAlg;
-  //string dataFile = "../Data/";
-  //dataFile.append(argv[1]);
-  string dataFile = argv[1];
+  runStats theStats;
+
+    // options start with "--", everything else is
+    // <data file> <0 = global, 1 = local, 2 = semi-global> [parameter file]
+    // --linear-space runs the global alignment in O(n + m) memory
+    // --score-only runs the local alignment with the striped SIMD kernel,
+    //   reporting only the score and where it ends (global: only the
+    //   score, from one pass in linear space; not with semi-global)
+    // --check also runs the scalar version and compares the two
+    // --threads N fills the table on N threads (0 = one per core)
+    // --tile N fills the table in N x N tiles (0 = sized to the L1 cache)
+    // --band K runs the global alignment in a band of +/- K around
+    //   the diagonal, widening it as needed (0 = default width)
+    // --batch aligns every pair of records in the data file, or with
+    //   --targets <file>, every record of the data file against every
+    //   record of that file, one summary line per pair
+    // --jobs N runs N pairs at a time in batch mode (0 = one per core)
+    // --lanes runs global batch pairs many at a time in SIMD lanes
+    // --top K reports the K best local alignments that share no cell
+    // --edit runs the global alignment with unit costs (edit distance),
+    //   with --score-only only the distance
+    // --screen K drops batch pairs more than K edits apart
+    // --checkpoint K keeps every K-th row of scores and fills each band
+    //   again for the backtrace (0 = the K with the least memory)
+    // --sweep <file> runs the batch pairs once for every scoring
+    //   profile in that file (sweep.h), instead of the parameter file
+    // --json <file> appends the report and its timing (runStats.h)
+    //   to that file as one JSON line, "-" for the console
+    // --mem-budget MB is the memory the planner (planner.h) picks the
+    //   way of aligning for, when none is given (0 = half the machine),
+    //   shared by the workers in batch mode
+    // --anchor L runs the global alignment through the chained maximal
+    //   unique matches of L or more (anchored.h), the DP only between
+    //   them (0 = 20)
+    // --stats-only runs 0 / 1 / 2 (or the batch pairs) down to the
+    //   score and the counts only, in two rows with no backtrace
+    //   (not with --lanes or --sweep)
+
+  vector <string> args;
+  int linearSpace = 0;
+  int scoreOnly = 0;
+  int checkScalar = 0;
+  int threads = 1;
+  int band = -1;
+  int batch = 0;
+  int jobs = 0;
+  int lanes = 0;
+  int top = 0;
+  int edit = 0;
+  int screen = -1;
+  int checkpoint = -1;
+  int memBudget = 0;
+  int anchor = -1;
+  int statsOnly = 0;
+  size_t budget = 0, bandBudget = 0;
+  bool scoreTable = false;
+  string targetFile;
+  string sweepFile;
+  string jsonFile;
+  string method = "table";
+
+  for (int a = 1; a < argc; a++)
+  {
+    string theArg = argv[a];
+
+    if (theArg == "--linear-space")
+    {
+      linearSpace = 1;
+    } // end if linear space option
+    else if (theArg == "--score-only")
+    {
+      scoreOnly = 1;
+    } // end else if score only option
+    else if (theArg == "--stats-only")
+    {
+      statsOnly = 1;
+    } // end else if statistics only option
+    else if (theArg == "--check")
+    {
+      checkScalar = 1;
+    } // end else if check option
+    else if (theArg == "--threads" && a + 1 < argc)
+    {
+      a++;
+      threads = atoi (argv[a]);
+
+      if (threads <= 0)
+      {
+        threads = thread::hardware_concurrency ();
+      }
+      if (threads <= 0)
+      {
+        threads = 1;
+      }
+    } // end else if threads option
+    else if (theArg == "--tile" && a + 1 < argc)
+    {
+      a++;
+      wavefrontTileSize = atoi (argv[a]);
+    } // end else if tile option
+    else if (theArg == "--band" && a + 1 < argc)
+    {
+      a++;
+      band = atoi (argv[a]);
 
-  ifstream inFileOne (dataFile);
-  if (!inFileOne)
+      if (band <= 0)
+      {
+        band = BAND_DEFAULT_WIDTH;
+      }
+    } // end else if band option
+    else if (theArg == "--batch")
+    {
+      batch = 1;
+    } // end else if batch option
+    else if (theArg == "--targets" && a + 1 < argc)
+    {
+      a++;
+      targetFile = argv[a];
+    } // end else if targets option
+    else if (theArg == "--jobs" && a + 1 < argc)
+    {
+      a++;
+      jobs = atoi (argv[a]);
+    } // end else if jobs option
+    else if (theArg == "--lanes")
+    {
+      lanes = 1;
+    } // end else if lanes option
+    else if (theArg == "--top" && a + 1 < argc)
+    {
+      a++;
+      top = atoi (argv[a]);
+    } // end else if top option
+    else if (theArg == "--edit")
+    {
+      edit = 1;
+    } // end else if edit option
+    else if (theArg == "--screen" && a + 1 < argc)
+    {
+      a++;
+      screen = atoi (argv[a]);
+    } // end else if screen option
+    else if (theArg == "--checkpoint" && a + 1 < argc)
+    {
+      a++;
+      checkpoint = atoi (argv[a]);
+
+      if (checkpoint < 0)
+      {
+        checkpoint = 0;
+      }
+    } // end else if checkpoint option
+    else if (theArg == "--sweep" && a + 1 < argc)
+    {
+      a++;
+      sweepFile = argv[a];
+    } // end else if sweep option
+    else if (theArg == "--mem-budget" && a + 1 < argc)
+    {
+      a++;
+      memBudget = atoi (argv[a]);
+    } // end else if memory budget option
+    else if (theArg == "--anchor" && a + 1 < argc)
+    {
+      a++;
+      anchor = atoi (argv[a]);
+
+      if (anchor < 0)
+      {
+        anchor = 0;
+      }
+    } // end else if anchor option
+    else if (theArg == "--json" && a + 1 < argc)
+    {
+      a++;
+      jsonFile = argv[a];
+    } // end else if json option
+    else if (theArg.compare (0, 2, "--") == 0)
+    {
+      cout << "Unknown option " << theArg << " - ignoring" << endl;
+    } // end else if unknown option
+    else
+    {
+      args.push_back (theArg);
+    } // end else, positional argument
+
+  } // end loop through arguments
+
+  if (args.size () < 2)
   {
-    cout << "Unable to open file - exiting !!!" << endl;
+    cout << "Usage: " << argv[0] << " <data file>";
+    cout << " <0 = global, 1 = local, 2 = semi-global>";
+    cout << " [parameter file] [--linear-space] [--score-only [--check]]";
+    cout << " [--stats-only]";
+    cout << " [--threads N] [--tile N] [--band K] [--top K] [--edit]";
+    cout << " [--checkpoint K] [--anchor L] [--mem-budget MB]";
+    cout << " [--json <file>]";
+    cout << " [--batch [--targets <file>] [--jobs N] [--lanes]";
+    cout << " [--screen K] [--sweep <profile file>]]" << endl;
     return 0;
-  }
+  } // end if missing arguments
+
+  if (statsOnly == 1 && (lanes == 1 || sweepFile.length () > 0))
+  {
+    cout << "--stats-only can't be used with --lanes or --sweep - exiting !!!";
+    cout << endl;
+    return 0;
+  } // end if stats-only with a batch mode that has no such pass
+
+  if (scoreOnly == 1 && args[1] == "2")
+  {
+    cout << "--score-only can't be used with 2 (semi-global) - exiting !!!";
+    cout << endl;
+    return 0;
+  } // end if score-only with semi-global, which has no such kernel
+
+  //string dataFile = "../Data/";
+  //dataFile.append(argv[1]);
+  string dataFile = args[0];
 
-  ifstream inFileTwo (dataFile);
-  if (!inFileTwo)
+  fastaFile inFile;
+  if (!inFile.open (dataFile))
   {
     cout << "Unable to open file - exiting !!!" << endl;
     return 0;
   }
 
-  whichAlg = argv[2];
+  whichAlg = args[1];
   cout << "use: " << whichAlg << endl;
 
-  string lineOne, lineTwo;
   string seqNameOne, seqNameTwo;
-  string S1, S2, readS1, readS2;
+  string S1, S2;
 
   string inputFile;
 
-  if (argc > 3)
+  if (args.size () > 2)
   {
-    inputFile = argv[3];
+    inputFile = args[2];
   } // end read specified file
   else
   {
     inputFile = "parameters.config";
   } // end default file
 
-  readFile (inputFile, &match, &mismatch, &g, &h);
+  readFile (inputFile, &match, &mismatch, &g, &h, &matrix);
+
+  if (!setScoring (&scoring, matrix, match, mismatch))
+  {
+    cout << "Unable to read matrix " << matrix << " - exiting !!!" << endl;
+    return 0;
+  } // end if no substitution matrix
 
   cout << endl << "\t *** Parameter configuration values ***" << endl << endl;
   cout << "\tmatch:    " << match << endl;
   cout << "\tmismatch: " << mismatch << endl;
   cout << "\tg:        " << g << endl;
   cout << "\th:        " << h << endl;
-  cout << endl;
 
-    // read the data file(s):
+  if (matrix.length () > 0)
+  {
+    cout << "\tmatrix:   " << scoring.name << endl;
+  }
 
-  getline (inFileOne, lineOne);
+  cout << endl;
 
-    // if the line begins with '>', it is a label line,
-    // all characters up to the first space ' ', are
-    // part of the label
+  budget = (memBudget > 0) ? (size_t) memBudget << 20 : planDefaultBudget ();
 
-  if (lineOne[0] == '>')
+  if (batch == 1 || sweepFile.length () > 0)
   {
-    int i = 1;
+    vector <string> qNames, tNames;
+    vector <packedSeq> qSeqs, tSeqs;
+    bool allPairs = (targetFile.length () == 0);
 
-    while (lineOne[i] && lineOne[i] != ' ')
+    readFasta (dataFile, qNames, qSeqs);
+
+    if (!allPairs && readFasta (targetFile, tNames, tSeqs) == 0)
     {
-      i++;
-    } // end while loop
+      cout << "Unable to open file " << targetFile << " - exiting !!!" << endl;
+      return 0;
+    } // end if no targets
+
+    if (jobs <= 0)
+    {
+      jobs = thread::hardware_concurrency ();
+    }
+
+    if (jobs <= 0)
+    {
+      jobs = 1;
+    } // end if the number of cores isn't known
 
-    seqNameOne.append (lineOne, 1,i - 1);
+    int mode = (whichAlg == "1") ? ALIGN_LOCAL :
+               (whichAlg == "2") ? ALIGN_SEMIGLOBAL : ALIGN_GLOBAL;
 
-  } // end if header, get sequence name
+    cout << "Running " << ( (mode == ALIGN_LOCAL) ? "Local" :
+                            (mode == ALIGN_SEMIGLOBAL) ? "Semi-global"
+                                                       : "Global" );
+    cout << " batch on " << jobs << " threads . . . ";
+    cout << endl << endl;
 
-    // The second set of data appears after the first one,
-    // read the first line, then skip over it and read the
-    // second line, then, read until we find another '>'
-    // for the second label line and capture it's label:
+    int pairCount = 0;
 
-  getline (inFileTwo, lineTwo);
-  int flag = 0;
-  while (flag == 0)
-  {
-    getline (inFileTwo, lineTwo);
-    if (lineTwo[0] == '>')
+    if (sweepFile.length () > 0)
+    {
+      vector <sweepProfile> profiles;
+
+      if (readProfiles (sweepFile, profiles) <= 0)
+      {
+        cout << "No profiles in " << sweepFile << " - exiting !!!" << endl;
+        return 0;
+      } // end if no profiles
+
+      cout << "# profiles: " << profiles.size () << endl;
+      pairCount = runSweep (qNames, qSeqs, tNames, tSeqs, allPairs,
+                            profiles, mode, jobs, (lanes == 1), screen,
+                            budget / jobs);
+    } // end if a parameter sweep
+    else if (lanes == 1 && mode == ALIGN_GLOBAL)
+    {
+      pairCount = runBatchLanes (qNames, qSeqs, tNames, tSeqs, allPairs,
+                                 scoring, g, h, jobs, screen);
+    } // end if global in SIMD lanes
+    else
     {
-      flag = 1;
-    } // end set flag when second label line found
+      pairCount = runBatch (qNames, qSeqs, tNames, tSeqs, allPairs,
+                            scoring, g, h, mode, jobs, screen, budget / jobs,
+                            (statsOnly == 1) );
+    } // end else, a pair at a time
 
-  } // end find second label line
+    cout << endl << "pairs: " << pairCount << endl;
 
-  int i = 1;
+    return 0;
+
+  } // end if batch mode
 
-  while (lineTwo[i] && lineTwo[i] != ' ')
+    // the first two records of the data file (fastaMap.h),
+    // the name of each is its label up to the first space
+
+  if (inFile.records.size () < 2)
   {
-    i++;
-  }
-  seqNameTwo.append (lineTwo, 1,i - 1);
+    cout << "Need two sequences in " << dataFile << " - exiting !!!" << endl;
+    return 0;
+  } // end if not two records
+
+  seqNameOne = inFile.records[0].name.str ();
+  seqNameTwo = inFile.records[1].name.str ();
+  S1 = inFile.records[0].seq.str ();
+  S2 = inFile.records[1].seq.str ();
+
+    // from here on the aligners time their phases into theStats,
+    // the parse is everything up to now
+
+  alignStats = &theStats;
+  statsLap (STATS_PARSE);
 
-    // read line by line from each file
-    // and send each line to runGlobal
+  cout << "Sequence 1 = \"" << seqNameOne << "\", length = " << S1.length () << " characters" << endl;
+  cout << "Sequence 2 = \"" << seqNameTwo << "\", length = " << S2.length () << " characters" << endl;
 
-  getline (inFileOne, lineOne);
+    // no way of aligning asked for: the planner (planner.h) picks
+    // the fastest one that fits in the memory budget
 
-  while (lineOne[0] != '>')
+  if (linearSpace == 0 && band <= 0 && checkpoint < 0 && top <= 0 &&
+      edit == 0 && anchor < 0 && statsOnly == 0 &&
+      (whichAlg == "0" || whichAlg == "1" || whichAlg == "2") )
   {
-    S1.append (cleanString (lineOne) );
-    getline (inFileOne, lineOne);
-  } // end read all of first data section
+    int mode = (whichAlg == "1") ? ALIGN_LOCAL :
+               (whichAlg == "2") ? ALIGN_SEMIGLOBAL : ALIGN_GLOBAL;
+    alignPlan plan = planAlignment (S1, S2, mode, h, (scoreOnly == 1),
+                                    true, threads, budget);
+
+    cout << endl;
+    printPlan (plan, budget);
+
+    if (plan.strategy == PLAN_FULL && scoreOnly == 1)
+    {
+      scoreTable = true;
+    }
+    else if (plan.strategy == PLAN_BANDED)
+    {
+      band = plan.k;
+      bandBudget = budget;
+    }
+    else if (plan.strategy == PLAN_CHECKPOINT)
+    {
+      checkpoint = plan.k;
+    }
+    else if (plan.strategy == PLAN_LINEAR)
+    {
+      linearSpace = 1;
+    }
+  } // end if planned
 
-  while (getline (inFileTwo, lineTwo) )
+  if (scoreOnly == 1 && (whichAlg == "1" || (whichAlg == "0" && edit == 0)) )
   {
-    S2.append (cleanString (lineTwo) );
-  } // end while loop to get second data section
+    int endI = 0, endJ = 0;
+    string kernel;
+    bool local = (whichAlg == "1");
+
+    if (local)
+    {
+      cout << endl << "Running Local, score only . . . " << endl << endl;
+      statsMark ();
+      localScore = runLocalScore (S1, S2, scoring, g, h,
+                                  &endI, &endJ, &kernel);
+      statsCells ( (long long) S1.size () * S2.size ());
+      statsLap (STATS_FILL);
+      cout << "kernel: " << kernel << endl;
+      cout << endl << "Local optimal score = " << localScore << endl;
+      cout << "ends at S1 position " << endI << ", S2 position " << endJ;
+      cout << endl << endl;
+    } // end if local, the striped kernel
+    else
+    {
+      cout << endl << "Running Global, score only . . . " << endl << endl;
+
+      if (scoreTable)
+      {
+        alignResult theResult;
+
+        globalScore = alignPair (S1, S2, scoring, g, h, ALIGN_GLOBAL,
+                                 threads, NULL, theResult);
+      } // end if the table fits, its fill is the faster one
+      else
+      {
+        globalScore = globalScoreLinear (S1, S2, scoring, g, h);
+      }
+
+      cout << "Global optimal score = " << globalScore << endl << endl;
+    } // end else global, the table or one linear pass
+
+    if (local && checkScalar == 1)
+    {
+      int checkI = 0, checkJ = 0;
+      int checkScore = localScoreScalar (S1, S2, scoring, g, h,
+                                         &checkI, &checkJ);
+
+      if ( (checkScore == localScore) && (checkI == endI) && (checkJ == endJ) )
+      {
+        cout << "scalar check: OK" << endl << endl;
+      }
+      else
+      {
+        cout << "scalar check: MISMATCH, scalar score = " << checkScore;
+        cout << " ends at S1 position " << checkI << ", S2 position ";
+        cout << checkJ << endl << endl;
+      }
+
+    } // end if check against scalar
 
-  /*
-  while (getline (inFileOne, lineOne) && getline (inFileTwo, lineTwo) )
+    printStats (theStats);
+
+    if (jsonFile.length () > 0 &&
+        !printStatsJson (jsonFile, theStats, dataFile,
+                         local ? "local" : "global",
+                         scoreTable ? "table" : "score-only",
+                         S1.size () + 1, S2.size () + 1, 1,
+                         local ? localScore : globalScore, 0, 0, 0, 0))
+    {
+      cout << "Unable to open " << jsonFile << endl;
+    } // end if the JSON line can't be written
+
+    return 0;
+
+  } // end if score only, runLocalScore / globalScoreLinear
+  else if (statsOnly == 1 &&
+           (whichAlg == "0" || whichAlg == "1" || whichAlg == "2") )
+  {
+    int mode = (whichAlg == "1") ? ALIGN_LOCAL :
+               (whichAlg == "2") ? ALIGN_SEMIGLOBAL : ALIGN_GLOBAL;
+    string name = (mode == ALIGN_LOCAL) ? "Local" :
+                  (mode == ALIGN_SEMIGLOBAL) ? "Semi-global" : "Global";
+    int &score = (mode == ALIGN_LOCAL) ? localScore :
+                 (mode == ALIGN_SEMIGLOBAL) ? semiScore : globalScore;
+
+    method = "stats-only";
+
+    cout << endl << "Running " << name << ", statistics only . . . ";
+    cout << endl << endl;
+    score = runStatsOnly (S1, S2, scoring, g, h, mode,
+                          &matchCount, &mismatchCount,
+                          &gapCount, &openingGap);
+    cout << name << " optimal score = " << score << endl << endl;
+  } // end else if statistics only, runStatsOnly
+  else if (whichAlg == "0" && edit == 1)
+  {
+    cout << endl << "Running Global, unit cost . . . " << endl << endl;
+    method = (scoreOnly == 1) ? "edit-distance" : "edit";
+    globalScore = runGlobalEdit (S1, S2, (scoreOnly == 1),
+                                 &matchCount, &mismatchCount,
+                                 &gapCount, &openingGap);
+    cout << endl << "Edit distance = " << globalScore << endl << endl;
+  } // end if 0 with unit costs, runGlobalEdit
+  else if (whichAlg == "0" && anchor >= 0)
+  {
+    cout << endl << "Running Global from anchors . . . " << endl << endl;
+    method = "anchored";
+    globalScore = runGlobalAnchored (S1, S2, scoring, g, h, anchor, budget,
+                                     &matchCount, &mismatchCount,
+                                     &gapCount, &openingGap);
+    cout << endl << "Global score through the anchors = " << globalScore;
+    cout << endl << endl;
+  } // end if 0 from anchors, runGlobalAnchored
+  else if (whichAlg == "0" && linearSpace == 1)
   {
+    cout << endl << "Running Global in linear space . . . " << endl << endl;
+    method = "linear-space";
+    globalScore = runGlobalLinear (S1, S2, scoring, g, h,
+                                    &matchCount, &mismatchCount,
+                                    &gapCount, &openingGap);
+    cout << endl << "Global optimal score = " << globalScore << endl << endl;
+  } // end if 0 in linear space, runGlobalLinear
+  else if (whichAlg == "0" && band > 0)
+  {
+    bool fits = true;
 
-    S1.append (cleanString (lineOne) );
-    S2.append (cleanString (lineTwo) );
+    cout << endl << "Running Global in a band . . . " << endl << endl;
+    method = "banded";
+    globalScore = runGlobalBanded (S1, S2, scoring, g, h, band,
+                                    &matchCount, &mismatchCount,
+                                    &gapCount, &openingGap,
+                                    bandBudget, &fits);
 
-  } // end while loop to get file text input
-  */
+    if (!fits)
+    {
+      alignPlan plan = planAlignment (S1, S2, ALIGN_GLOBAL, h, false,
+                                      false, threads, budget);
 
-  cout << "Sequence 1 = \"" << seqNameOne << "\", length = " << S1.length () << " characters" << endl;
-  cout << "Sequence 2 = \"" << seqNameTwo << "\", length = " << S2.length () << " characters" << endl;
+      printPlan (plan, budget);
 
-  if (strcmp (argv[2], "0") == 0 )
+      if (plan.strategy == PLAN_CHECKPOINT)
+      {
+        method = "checkpoint";
+        globalScore = runCheckpoint (S1, S2, scoring, g, h, ALIGN_GLOBAL,
+                                     plan.k, &matchCount, &mismatchCount,
+                                     &gapCount, &openingGap);
+      }
+      else
+      {
+        method = "linear-space";
+        globalScore = runGlobalLinear (S1, S2, scoring, g, h,
+                                       &matchCount, &mismatchCount,
+                                       &gapCount, &openingGap);
+      }
+    } // end if the band outgrew the budget, the next best plan
+    cout << endl << "Global optimal score = " << globalScore << endl << endl;
+  } // end if 0 in a band, runGlobalBanded
+  else if (checkpoint >= 0 && top <= 0 &&
+           (whichAlg == "0" || whichAlg == "1" || whichAlg == "2") )
+  {
+    int mode = (whichAlg == "1") ? ALIGN_LOCAL :
+               (whichAlg == "2") ? ALIGN_SEMIGLOBAL : ALIGN_GLOBAL;
+    string name = (mode == ALIGN_LOCAL) ? "Local" :
+                  (mode == ALIGN_SEMIGLOBAL) ? "Semi-global" : "Global";
+    int &score = (mode == ALIGN_LOCAL) ? localScore :
+                 (mode == ALIGN_SEMIGLOBAL) ? semiScore : globalScore;
+
+    method = "checkpoint";
+
+    cout << endl << "Running " << name << " with checkpoints . . . ";
+    cout << endl << endl;
+    score = runCheckpoint (S1, S2, scoring, g, h, mode, checkpoint,
+                           &matchCount, &mismatchCount,
+                           &gapCount, &openingGap);
+    cout << endl << name << " optimal score = " << score << endl << endl;
+  } // end else if checkpointed backtrace, runCheckpoint
+  else if (whichAlg == "0")
   {
     cout << endl << "Running Global . . . " << endl << endl;
-    globalScore = runGlobal (S1, S2, match, mismatch, g, h,
+    globalScore = runGlobal (S1, S2, scoring, g, h,
                               &matchCount, &mismatchCount,
-                              &gapCount, &openingGap);
+                              &gapCount, &openingGap, threads);
     cout << endl << "Global optimal score = " << globalScore << endl << endl;
   } // end if 0, runGlobal
-  else if (strcmp (argv[2], "1") == 0)
+  else if (whichAlg == "1" && top > 0)
+  {
+    cout << endl << "Running Local, top " << top << " . . . " << endl << endl;
+    method = "top";
+    localScore = runLocalTop (S1, S2, scoring, g, h, top,
+                              &matchCount, &mismatchCount,
+                              &gapCount, &openingGap);
+    cout << endl << "Local optimal score = " << localScore << endl << endl;
+  } // end else if 1 with top, runLocalTop
+  else if (whichAlg == "2")
+  {
+    cout << endl << "Running Semi-global . . . " << endl << endl;
+    semiScore = runSemiGlobal (S1, S2, scoring, g, h,
+                               &matchCount, &mismatchCount,
+                               &gapCount, &openingGap, threads);
+    cout << endl << "Semi-global optimal score = " << semiScore << endl;
+    cout << endl;
+  } // end else if 2, runSemiGlobal
+  else if (whichAlg == "1")
   {
     cout << endl << "Running Local . . . " << endl << endl;
-    localScore = runLocal (S1, S2, match, mismatch, g, h,
-              &matchCount, &mismatchCount, &gapCount, &openingGap);
+    localScore = runLocal (S1, S2, scoring, g, h,
+              &matchCount, &mismatchCount, &gapCount, &openingGap,
+              threads);
     cout << endl << "Local optimal score = " << localScore << endl << endl;
   } // end else if 1, runLocal
   else
   {
     cout << endl << "Paramater not recognized" << endl;
     cout << "Running default Global function:" << endl << endl;
-    globalScore = runGlobal (S1, S2, match, mismatch, g, h,
+    globalScore = runGlobal (S1, S2, scoring, g, h,
                               &matchCount, &mismatchCount,
-                              &gapCount, &openingGap);
+                              &gapCount, &openingGap, threads);
   } // end catch-all
 
-  inFileOne.close ();
-  inFileTwo.close ();
+  inFile.close ();
 
   cout << "Report:";
 
@@ -1389,4 +1095,21 @@ int main (int argc, char * argv [])
   cout << gapCount << "/" << S1.length() << "(";
   cout << ( (100) * (float (gapCount) / S1.length() ) ) << "%)" << endl << endl;
 
+  printStats (theStats);
+
+  if (jsonFile.length () > 0)
+  {
+    string mode = (whichAlg == "1") ? "local" :
+                  (whichAlg == "2") ? "semi-global" : "global";
+    int score = (whichAlg == "1") ? localScore :
+                (whichAlg == "2") ? semiScore : globalScore;
+
+    if (!printStatsJson (jsonFile, theStats, dataFile, mode, method,
+                         S1.size () + 1, S2.size () + 1, threads, score,
+                         matchCount, mismatchCount, gapCount, openingGap))
+    {
+      cout << "Unable to open " << jsonFile << endl;
+    } // end if the JSON line can't be written
+  } // end if a JSON line
+
 } // end main function
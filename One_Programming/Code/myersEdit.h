@@ -0,0 +1,349 @@
+/*
+* Cpt_S 471
+* Programming Assignment #1
+*
+* myersEdit.h
+*
+* Unit cost global alignment (edit distance: every mismatch, every
+* inserted and every deleted character costs 1) with Myers' bit
+* vectors (Myers, "A fast bit-vector algorithm for approximate
+* string matching based on dynamic programming", 1999, global form
+* and blocks as in Hyyro 2003).
+*
+* A column of the table is kept as the differences between each cell
+* and the one above it: Pv has a bit for every +1, Mv for every -1.
+* S1 runs down the column, 64 characters to a 64 bit word, so a
+* whole word of the column is worked out in about 15 operations;
+* S1 longer than 64 is cut into blocks of 64 rows, each block
+* passing the difference in its bottom row on to the block below.
+* Characters are compared by their code (scoring.h), one per
+* distinct character, so 'a' and 'A' differ as in the DP.
+*
+* myersDistance only keeps one column and can give up early once the
+* distance is sure to be more than "maxDist" (every path from the
+* column to the last cell costs at least the block bottoms allow),
+* which is what the batch --screen prefilter uses.  myersAlign keeps
+* every column (2 bits a cell, from a dpArena) and walks back from
+* the last cell for the alignment.
+*
+*/
+
+#ifndef MYERSEDIT_H
+#define MYERSEDIT_H
+
+#include <stdint.h>
+#include <string.h>
+#include <iostream>
+#include <vector>
+#include "alignCore.h"
+#include "dpArena.h"
+#include "runStats.h"
+#include "scoring.h"
+
+using namespace std;
+
+#define MYERS_WORD 64
+
+  // myersPattern: for every block of S1 and every character code,
+  // a bit for each row of the block that has that character
+
+struct myersPattern
+{
+  int length;
+  int blocks;
+  vector <uint64_t> peq;
+
+  myersPattern (string &S1)
+  {
+    length = S1.size ();
+    blocks = (length + MYERS_WORD - 1) / MYERS_WORD;
+    peq.assign ( (size_t) blocks * SCORE_ALPHABET, 0);
+
+    for (int i = 0; i < length; i++)
+    {
+      peq[ (size_t) (i / MYERS_WORD) * SCORE_ALPHABET + scoreCode (S1[i])] |=
+        (uint64_t) 1 << (i % MYERS_WORD);
+    }
+  }
+
+  const uint64_t *eq (char c) const
+  {
+    return &peq[scoreCode (c)];
+  }
+};
+
+  // myersBlock function:
+  // one block of one column: Pv / Mv of the column before in,
+  // this column out, eq the rows that match the column's character,
+  // hin the difference coming in at the top (+1, 0, -1)
+  // returns the difference at row "bottom" of the block
+
+static inline int myersBlock (uint64_t &Pv, uint64_t &Mv, uint64_t eq,
+                               int hin, int bottom)
+{
+  uint64_t hinMinus = (hin < 0) ? 1 : 0;
+  uint64_t Xv = eq | Mv;
+
+  eq |= hinMinus;
+
+  uint64_t Xh = ( ( (eq & Pv) + Pv) ^ Pv) | eq;
+  uint64_t Ph = Mv | ~(Xh | Pv);
+  uint64_t Mh = Pv & Xh;
+  int hout = (int) ( (Ph >> bottom) & 1) - (int) ( (Mh >> bottom) & 1);
+
+  Ph = (Ph << 1) | ( (hin > 0) ? 1 : 0);
+  Mh = (Mh << 1) | hinMinus;
+
+  Pv = Mh | ~(Xv | Ph);
+  Mv = Ph & Xv;
+
+  return hout;
+
+} // end myersBlock function
+
+  // myersFill function:
+  // every column of the table of S1 (the pattern) against S2,
+  // keeping column j's Pv / Mv in columns[(j - 1) * 2 * blocks ...]
+  // if columns is not NULL
+  // maxDist >= 0: stops once the distance must be more than maxDist
+  // returns the edit distance (maxDist + 1 if it gave up)
+
+static int myersFill (myersPattern &P, string &S2, int maxDist,
+                       uint64_t *columns)
+{
+  int m = P.length;
+  int n = S2.size ();
+  int blocks = P.blocks;
+
+  if (maxDist >= 0 && abs (m - n) > maxDist)
+  {
+    return maxDist + 1;
+  } // end if the lengths alone cost too much
+
+  if (m == 0 || n == 0)
+  {
+    return m + n;
+  } // end if all gaps
+
+  vector <uint64_t> Pv (blocks, ~ (uint64_t) 0);
+  vector <uint64_t> Mv (blocks, 0);
+  vector <int> bottom (blocks);
+  vector <int> bottomScore (blocks);
+
+  for (int b = 0; b < blocks; b++)
+  {
+    bottom[b] = (b == blocks - 1) ? (m - 1) % MYERS_WORD : MYERS_WORD - 1;
+    bottomScore[b] = b * MYERS_WORD + bottom[b] + 1;
+  } // end column 0, T(i,0) = i
+
+  for (int j = 1; j <= n; j++)
+  {
+    const uint64_t *eq = P.eq (S2[j-1]);
+    int hin = 1;
+
+    for (int b = 0; b < blocks; b++)
+    {
+      hin = myersBlock (Pv[b], Mv[b], eq[ (size_t) b * SCORE_ALPHABET],
+                        hin, bottom[b]);
+      bottomScore[b] += hin;
+    } // end for each block, top down
+
+    if (columns != NULL)
+    {
+      uint64_t *column = &columns[ (size_t) (j - 1) * 2 * blocks];
+
+      for (int b = 0; b < blocks; b++)
+      {
+        column[2 * b] = Pv[b];
+        column[2 * b + 1] = Mv[b];
+      }
+    } // end if keeping the columns
+
+    if (maxDist >= 0)
+    {
+        // a path to the last cell leaves this column at some row i
+        // of some block (row 0 counts with the first block):
+        // T(i,j) >= bottomScore - (bottom - i) and the rest costs at
+        // least the difference of what is left of S1 and of S2
+
+      int best = INT_MAX;
+
+      for (int b = 0; b < blocks && best > maxDist; b++)
+      {
+        int row = b * MYERS_WORD + bottom[b] + 1;
+        int span = bottom[b] + (b == 0);
+        int rest = abs ( (m - row) - (n - j));
+        int bound = bottomScore[b] - span + ( (rest > span) ? rest - span : 0);
+
+        if (bound < best)
+        {
+          best = bound;
+        }
+      } // end for each block
+
+      if (best > maxDist)
+      {
+        return maxDist + 1;
+      }
+    } // end if we can give up early
+
+  } // end for each column
+
+  if (maxDist >= 0 && bottomScore[blocks - 1] > maxDist)
+  {
+    return maxDist + 1;
+  }
+
+  return bottomScore[blocks - 1];
+
+} // end myersFill function
+
+  // myersDistance function:
+  // the edit distance of S1 and S2, or maxDist + 1 if that is
+  // more than maxDist (maxDist < 0: no limit)
+
+int myersDistance (string &S1, string &S2, int maxDist)
+{
+  myersPattern P (S1);
+
+  return myersFill (P, S2, maxDist, NULL);
+
+} // end myersDistance function
+
+  // myersColumnDiff function:
+  // T(i,j) - T(i-1,j) from the kept column j (j >= 1, i >= 1)
+
+static inline int myersColumnDiff (uint64_t *columns, int blocks,
+                                    int i, int j)
+{
+  uint64_t *column = &columns[ (size_t) (j - 1) * 2 * blocks];
+  int b = (i - 1) / MYERS_WORD;
+  int bit = (i - 1) % MYERS_WORD;
+
+  return (int) ( (column[2 * b] >> bit) & 1) -
+         (int) ( (column[2 * b + 1] >> bit) & 1);
+
+} // end myersColumnDiff function
+
+  // myersCell function:
+  // T(i,j) from the kept column j: j plus the differences of rows 1..i
+
+static int myersCell (uint64_t *columns, int blocks, int i, int j)
+{
+  if (j == 0)
+  {
+    return i;
+  }
+
+  uint64_t *column = &columns[ (size_t) (j - 1) * 2 * blocks];
+  int score = j;
+
+  for (int b = 0; b * MYERS_WORD < i; b++)
+  {
+    int rows = i - b * MYERS_WORD;
+    uint64_t mask = (rows >= MYERS_WORD) ? ~ (uint64_t) 0
+                                         : ( (uint64_t) 1 << rows) - 1;
+
+    score += __builtin_popcountll (column[2 * b] & mask) -
+             __builtin_popcountll (column[2 * b + 1] & mask);
+  }
+
+  return score;
+
+} // end myersCell function
+
+  // myersAlign function:
+  // the edit distance of S1 and S2 and an alignment with it,
+  // theS1 / theS2 get the aligned sequences, left to right
+  // (substitutions first, then deletions, then insertions on a tie)
+  // the columns come from "arena"
+  // returns the edit distance, -1 if out of memory
+
+int myersAlign (string &S1, string &S2, dpArena &arena,
+                 vector <char> &theS1, vector <char> &theS2)
+{
+  myersPattern P (S1);
+  int m = S1.size ();
+  int n = S2.size ();
+  uint64_t *columns = NULL;
+
+  statsMark ();
+  theS1.clear ();
+  theS2.clear ();
+  arena.reset ();
+
+  if (m > 0 && n > 0)
+  {
+    columns = (uint64_t *) arena.take ( (size_t) n * 2 * P.blocks *
+                                        sizeof (uint64_t));
+
+    if (columns == NULL)
+    {
+      return -1;
+    }
+  } // end if there is a table
+
+  statsLap (STATS_INIT);
+
+  int distance = myersFill (P, S2, -1, columns);
+  int i = m, j = n;
+
+  statsCells ( (long long) m * n);
+  statsLap (STATS_FILL);
+  int score = distance;
+
+  while (i > 0 && j > 0)
+  {
+    int left = myersCell (columns, P.blocks, i, j - 1);
+    int diag = left - ( (j > 1) ? myersColumnDiff (columns, P.blocks, i, j - 1)
+                                : 1);
+    int cost = (scoreCode (S1[i-1]) == scoreCode (S2[j-1])) ? 0 : 1;
+
+    if (diag + cost == score)
+    {
+      theS1.push_back (S1[i-1]);
+      theS2.push_back (S2[j-1]);
+      score = diag;
+      i--;
+      j--;
+    } // end if substitution
+    else if (myersColumnDiff (columns, P.blocks, i, j) == 1)
+    {
+      theS1.push_back (S1[i-1]);
+      theS2.push_back ('-');
+      score--;
+      i--;
+    } // end else if deletion
+    else
+    {
+      theS1.push_back ('-');
+      theS2.push_back (S2[j-1]);
+      score = left;
+      j--;
+    } // end else, insertion
+
+  } // end while loop to backtrace
+
+  for (; i > 0; i--)
+  {
+    theS1.push_back (S1[i-1]);
+    theS2.push_back ('-');
+  }
+
+  for (; j > 0; j--)
+  {
+    theS1.push_back ('-');
+    theS2.push_back (S2[j-1]);
+  }
+
+  theS1 = reverseVector (theS1);
+  theS2 = reverseVector (theS2);
+
+  statsLap (STATS_TRACE);
+  statsBytes (arena.peak);
+
+  return distance;
+
+} // end myersAlign function
+
+#endif
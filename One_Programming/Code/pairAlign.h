@@ -0,0 +1,211 @@
+/*
+* Cpt_S 471
+* Programming Assignment #1
+*
+* pairAlign.h
+*
+* The part of runGlobal / runLocal / runSemiGlobal that does the
+* work and prints nothing: fill the table, run the backtrace and
+* hand back the two aligned sequences, or the CIGAR and counts of
+* the alignment (cigar.h).  runGlobal / runLocal print what it
+* finds, the batch driver (batch.h) only counts it.
+*
+*/
+
+#ifndef PAIRALIGN_H
+#define PAIRALIGN_H
+
+#include <string.h>
+#include <iostream>
+#include <vector>
+#include "alignCore.h"
+#include "traceback.h"
+#include "cigar.h"
+#include "wavefront.h"
+#include "dpArena.h"
+#include "scoring.h"
+#include "runStats.h"
+
+using namespace std;
+
+  // alignPairFill function:
+  // fills the table of alignPair into myTable and works out where
+  // the backtrace starts: (*endI, *endJ) in *state
+  // (local with nothing above 0, or semi-global with an empty S1:
+  // (0,0), an empty alignment)
+  // returns false if out of memory
+
+static bool alignPairFill (string &S1, string &S2, scoreScheme &scoring,
+                            int g, int h, int mode, int threads,
+                            dpArena &arena, traceMatrix &myTable,
+                            int *score, int *endI, int *endJ, int *state)
+{
+  int n = S1.size () + 1;
+  int m = S2.size () + 1;
+  int highScore = 0, maxI = 0, maxJ = 0;
+  ADP_cell lastCell;
+
+  if (mode == ALIGN_SEMIGLOBAL && n <= 1)
+  {
+    *score = 0;
+    *endI = 0;
+    *endJ = 0;
+    *state = 0;
+    return true;
+  } // end if an empty read, an empty alignment
+
+  bool filled = (myTable.bits != NULL) &&
+    scoreDispatch (scoring, [&] (auto sub)
+    {
+      return wavefrontFill (myTable, S1, S2, n, m, sub, g, h, mode, threads,
+                            arena, &lastCell, &highScore, &maxI, &maxJ);
+    });
+
+  if (!filled)
+  {
+    cout << "Not enough memory for the table - try --linear-space or --band";
+    cout << endl;
+    return false;
+  } // end if out of memory
+
+  if (mode == ALIGN_LOCAL)
+  {
+      // start at the position of the highest score and run
+      // back to where the scores before it are 0
+
+    *score = highScore;
+    *endI = (highScore > 0) ? maxI : 0;
+    *endJ = (highScore > 0) ? maxJ : 0;
+    *state = 0;
+  } // end if local
+  else if (mode == ALIGN_SEMIGLOBAL)
+  {
+      // start at the best cell of the last row and run back
+      // to the zeroeth row
+
+    *score = highScore;
+    *endI = maxI;
+    *endJ = maxJ;
+    *state = maxState (lastCell);
+  } // end else if semi-global
+  else
+  {
+      // start at the last cell and run back to T(0,0)
+
+    *score = cellMax (lastCell);
+    *endI = n - 1;
+    *endJ = m - 1;
+    *state = maxState (lastCell);
+  } // end else, global
+
+  return true;
+
+} // end alignPairFill function
+
+  // alignPair function:
+  // global, local or semi-global (mode, alignCore.h) alignment of
+  // S1 and S2, theS1 / theS2 get the aligned sequences, left to right,
+  // the table comes from "arena" (reset first, so it can be
+  // reused pair after pair), or from an arena of its own if NULL
+  // the fill is the wavefrontFill for the scorer of "scoring"
+  // endJ (if not NULL) gets the column of S2 the alignment ends at
+  // returns the optimal score
+
+int alignPair (string &S1, string &S2, scoreScheme &scoring, int g, int h,
+                int mode, int threads, dpArena *arena,
+                vector <char> &theS1, vector <char> &theS2,
+                int *endJ = NULL)
+{
+  int score = 0, maxI = 0, maxJ = 0, state = 0;
+  dpArena ownArena (true);
+
+  if (arena == NULL)
+  {
+    arena = &ownArena;
+  }
+
+  arena->reserve (wavefrontBytes (S1.size () + 1, S2.size () + 1, threads,
+                                  h));
+
+  traceMatrix myTable (S1.size () + 1, S2.size () + 1, h, *arena);
+
+  theS1.clear ();
+  theS2.clear ();
+
+  if (!alignPairFill (S1, S2, scoring, g, h, mode, threads, *arena, myTable,
+                      &score, &maxI, &maxJ, &state))
+  {
+    return 0;
+  } // end if out of memory
+
+  traceBack (myTable, S1, S2, maxI, maxJ, state, mode, theS1, theS2);
+
+  if (endJ != NULL)
+  {
+    *endJ = maxJ;
+  }
+
+  theS1 = reverseVector (theS1);
+  theS2 = reverseVector (theS2);
+
+  return score;
+
+} // end alignPair function
+
+  // alignPair function:
+  // the same alignment as a CIGAR and its counts (cigar.h),
+  // without the aligned sequences
+  // the phases, cells and table bytes go to alignStats (runStats.h)
+  // returns the optimal score (also in result.score)
+
+int alignPair (string &S1, string &S2, scoreScheme &scoring, int g, int h,
+                int mode, int threads, dpArena *arena, alignResult &result)
+{
+  int score = 0, maxI = 0, maxJ = 0, state = 0;
+  dpArena ownArena (true);
+
+  statsMark ();
+
+  if (arena == NULL)
+  {
+    arena = &ownArena;
+  }
+
+  arena->reserve (wavefrontBytes (S1.size () + 1, S2.size () + 1, threads,
+                                  h));
+
+  traceMatrix myTable (S1.size () + 1, S2.size () + 1, h, *arena);
+
+  statsLap (STATS_INIT);
+
+  if (!alignPairFill (S1, S2, scoring, g, h, mode, threads, *arena, myTable,
+                      &score, &maxI, &maxJ, &state))
+  {
+    maxI = 0;
+    maxJ = 0;
+  } // end if out of memory, an empty alignment
+  else
+  {
+    statsCells ( (long long) S1.size () * S2.size ());
+  }
+
+  statsLap (STATS_FILL);
+
+  cigarPath path = cigarStart (S1, S2, result, maxI, maxJ);
+
+  if (maxI > 0 || maxJ > 0)
+  {
+    tracePath (myTable, maxI, maxJ, state, mode, path);
+  }
+
+  cigarFinish (path, result);
+  result.score = score;
+
+  statsLap (STATS_TRACE);
+  statsBytes (arena->peak);
+
+  return score;
+
+} // end alignPair function
+
+#endif
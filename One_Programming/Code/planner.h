@@ -0,0 +1,265 @@
+/*
+* Cpt_S 471
+* Programming Assignment #1
+*
+* planner.h
+*
+* Picks how to align a pair from its size, what is wanted (only the
+* score, or the alignment and its counts) and a memory budget, so a
+* pair too big for the table runs another way instead of running
+* out of memory.  Fastest first:
+*
+*   score only   local: the striped kernel (stripedLocal.h), a few
+*                rows
+*   band         global, if the pair is close enough (its edit
+*                distance, myersEdit.h, gives the band) that a band
+*                of at most a quarter of the table fits (banded.h);
+*                a band cell takes about 3 times a table cell, so
+*                that is still faster than the table
+*   full table   runGlobal / runLocal / runSemiGlobal, half a byte
+*                a cell (a byte with h > 0, wavefront.h); global
+*                score only too, the tiled fill is faster than a
+*                linear pass
+*   score only   global: one linear pass (linearSpace.h), if the
+*                table doesn't fit
+*   checkpoints  every k-th row, about twice the time (checkpoint.h)
+*   linear space global, about twice the time, O(n + m) memory
+*                (linearSpace.h)
+*
+* Local and semi-global have no linear space version, so if even the
+* checkpoints don't fit they run with the checkpoints anyway (the
+* plan says it is over the budget).  The budget is --mem-budget MB,
+* or half of the memory of the machine; in batch mode each worker
+* gets its share.  Every way gives the same alignment, so the budget
+* only changes the time it takes.
+*
+*/
+
+#ifndef PLANNER_H
+#define PLANNER_H
+
+#include <string.h>
+#include <unistd.h>
+#include <iostream>
+#include "alignCore.h"
+#include "cigar.h"
+#include "wavefront.h"
+#include "pairAlign.h"
+#include "checkpoint.h"
+#include "banded.h"
+#include "linearSpace.h"
+#include "myersEdit.h"
+#include "dpArena.h"
+#include "scoring.h"
+
+using namespace std;
+
+#define PLAN_SCORE 0
+#define PLAN_FULL 1
+#define PLAN_BANDED 2
+#define PLAN_CHECKPOINT 3
+#define PLAN_LINEAR 4
+
+  // alignPlan: what planAlignment picked
+  // k: the band half width or the checkpoint rows
+  // bytes: about how much memory it takes
+
+struct alignPlan
+{
+  int strategy;
+  int k;
+  size_t bytes;
+};
+
+  // planDefaultBudget function:
+  // half of the memory of the machine, in bytes
+
+size_t planDefaultBudget ()
+{
+  long pages = sysconf (_SC_PHYS_PAGES);
+  long pageSize = sysconf (_SC_PAGESIZE);
+
+  if (pages <= 0 || pageSize <= 0)
+  {
+    return (size_t) 4 << 30;
+  } // end if the system doesn't say, 4 GB
+
+  return (size_t) pages * pageSize / 2;
+
+} // end planDefaultBudget function
+
+  // linearBytes function:
+  // memory of linear space (the rows, their crossings, the base
+  // table and the two aligned sequences)
+
+size_t linearBytes (int n, int m)
+{
+  return (size_t) (m + 1) * (2 * sizeof (ADP_cell) + 6 * sizeof (int)) +
+         LINEAR_BASE_CELLS * sizeof (ADP_cell) + 2 * (size_t) (n + m);
+
+} // end linearBytes function
+
+  // planAlignment function:
+  // the fastest way to align S1 and S2 in "mode" that fits in
+  // "budget" bytes
+  // h: the gap opening penalty (the table codes take twice the
+  // memory with h > 0, traceback.h)
+  // scoreOnly: only the score is wanted (not for semi-global)
+  // band: the band may be used (global only)
+
+alignPlan planAlignment (string &S1, string &S2, int mode, int h,
+                          bool scoreOnly, bool band, int threads,
+                          size_t budget)
+{
+  int n = S1.size () + 1;
+  int m = S2.size () + 1;
+  alignPlan plan;
+
+  plan.k = 0;
+  plan.strategy = PLAN_SCORE;
+  plan.bytes = 2 * (size_t) m * sizeof (ADP_cell);
+
+  if (scoreOnly && mode == ALIGN_LOCAL)
+  {
+    return plan;
+  } // end if only the local score
+
+  if (band && mode == ALIGN_GLOBAL && !scoreOnly)
+  {
+    size_t cellWidth = budget / ( (size_t) n * sizeof (ADP_cell));
+    int maxWidth = (cellWidth < (size_t) m / 4) ? cellWidth : m / 4;
+    int maxK = (maxWidth - 1 - abs (n - m)) / 2;
+
+    if (maxK >= 1)
+    {
+      int distance = myersDistance (S1, S2, maxK);
+
+      if (distance <= maxK)
+      {
+        plan.strategy = PLAN_BANDED;
+        plan.k = (distance > 0) ? distance : 1;
+        plan.bytes = bandBytes (n, m, plan.k);
+        return plan;
+      } // end if close enough for the band
+    } // end if a narrow enough band fits
+  } // end if the band may be used
+
+  size_t tableBytes = wavefrontBytes (n, m, threads, h);
+
+  if (tableBytes <= budget)
+  {
+    plan.strategy = PLAN_FULL;
+    plan.bytes = tableBytes;
+    return plan;
+  } // end if the table fits
+
+  if (scoreOnly && mode == ALIGN_GLOBAL)
+  {
+    return plan;
+  } // end if only the global score, too big for the table
+
+  plan.strategy = PLAN_CHECKPOINT;
+  plan.k = checkpointRows (n);
+  plan.bytes = checkpointBytes (n, m, plan.k, h);
+
+  if (plan.bytes <= budget || mode != ALIGN_GLOBAL)
+  {
+    return plan;
+  } // end if the checkpoints fit, or nothing smaller will do
+
+  plan.strategy = PLAN_LINEAR;
+  plan.k = 0;
+  plan.bytes = linearBytes (n, m);
+
+  return plan;
+
+} // end planAlignment function
+
+  // printPlan function:
+  // one line saying what the plan is and what it takes
+
+void printPlan (alignPlan &plan, size_t budget)
+{
+  cout << "plan: ";
+
+  if (plan.strategy == PLAN_SCORE)
+  {
+    cout << "score only";
+  }
+  else if (plan.strategy == PLAN_FULL)
+  {
+    cout << "full table";
+  }
+  else if (plan.strategy == PLAN_BANDED)
+  {
+    cout << "band of +/- " << plan.k;
+  }
+  else if (plan.strategy == PLAN_CHECKPOINT)
+  {
+    cout << "checkpoint every " << plan.k << " rows";
+  }
+  else
+  {
+    cout << "linear space";
+  }
+
+  cout << ", about " << plan.bytes / (1024 * 1024) << " MB of a ";
+  cout << budget / (1024 * 1024) << " MB budget";
+
+  if (plan.bytes > budget)
+  {
+    cout << " (over, nothing smaller)";
+  }
+
+  cout << endl;
+
+} // end printPlan function
+
+  // alignPlanned function:
+  // alignPair (the CIGAR one) the way planAlignment picks for
+  // "budget" bytes, on one thread; every way gives the same
+  // alignment, so the budget only changes the time it takes
+  // if the band outgrows the budget, the plan without it
+  // the arena is given back first if it holds more than the budget
+  // returns the optimal score (also in result.score)
+
+int alignPlanned (string &S1, string &S2, scoreScheme &scoring, int g, int h,
+                   int mode, size_t budget, dpArena &arena,
+                   alignResult &result)
+{
+  alignPlan plan = planAlignment (S1, S2, mode, h, false, true, 1, budget);
+
+  if (plan.strategy == PLAN_BANDED)
+  {
+    bandInfo info;
+
+    alignBanded (S1, S2, scoring, g, h, plan.k, budget, result, &info);
+
+    if (info.fits)
+    {
+      return result.score;
+    }
+
+    plan = planAlignment (S1, S2, mode, h, false, false, 1, budget);
+  } // end if in a band
+
+  if (arena.capacity () > budget)
+  {
+    arena.release ();
+  } // end if an earlier pair left too much
+
+  if (plan.strategy == PLAN_CHECKPOINT)
+  {
+    return alignCheckpoint (S1, S2, scoring, g, h, mode, plan.k, arena,
+                            result);
+  }
+  else if (plan.strategy == PLAN_LINEAR)
+  {
+    return alignLinear (S1, S2, scoring, g, h, result);
+  }
+
+  return alignPair (S1, S2, scoring, g, h, mode, 1, &arena, result);
+
+} // end alignPlanned function
+
+#endif
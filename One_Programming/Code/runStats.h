@@ -0,0 +1,289 @@
+/*
+* Cpt_S 471
+* Programming Assignment #1
+*
+* runStats.h
+*
+* Where the time and the memory of a run go, for the report: wall
+* time of the parse (data and parameter files), the matrix init
+* (taking the table and the edges from the arena), the fill and the
+* traceback, the cells the fill worked out, GCUPS (cells / fill
+* time / 10^9) and the most bytes the DP tables held at once
+* (the dpArena peak, dpArena.h, or the band of banded.h).
+*
+* The aligners add to *alignStats when it is set; main sets it for
+* a two-sequence run and leaves it NULL in batch mode, where the
+* workers would all write to it at once.  statsMark () starts a
+* phase, statsLap (phase) adds the time since the mark to that
+* phase and starts the next one.
+*
+* printStats adds the lines to the report, printStatsJson writes
+* the same numbers as one JSON line (--json <file>, "-" for the
+* console).
+*
+*/
+
+#ifndef RUNSTATS_H
+#define RUNSTATS_H
+
+#include <stdlib.h>
+#include <string.h>
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <chrono>
+#include <sys/resource.h>
+
+using namespace std;
+using namespace chrono;
+
+#define STATS_PARSE 0
+#define STATS_INIT 1
+#define STATS_FILL 2
+#define STATS_TRACE 3
+#define STATS_PHASES 4
+
+  // runStats: the numbers of one run
+  // traced: the traceback was timed apart from the fill (false for
+  // the aligners that trace as they fill, their fill has it)
+  // dpBytes: 0 if not known (linear space and the score-only
+  // kernels keep a few rows in vectors)
+
+struct runStats
+{
+  double seconds[STATS_PHASES];
+  long long cells;
+  size_t dpBytes;
+  bool traced;
+  steady_clock::time_point mark;
+
+  runStats ()
+  {
+    for (int p = 0; p < STATS_PHASES; p++)
+    {
+      seconds[p] = 0.0;
+    }
+
+    cells = 0;
+    dpBytes = 0;
+    traced = false;
+    mark = steady_clock::now ();
+  }
+};
+
+  // alignStats: the stats of the run, NULL = not kept
+
+runStats *alignStats = NULL;
+
+  // statsMark function:
+  // starts timing a phase
+
+static inline void statsMark ()
+{
+  if (alignStats != NULL)
+  {
+    alignStats->mark = steady_clock::now ();
+  }
+
+} // end statsMark function
+
+  // statsLap function:
+  // adds the time since the mark to "phase", the mark moves on
+
+static inline void statsLap (int phase)
+{
+  if (alignStats != NULL)
+  {
+    steady_clock::time_point now = steady_clock::now ();
+
+    alignStats->seconds[phase] +=
+      duration <double> (now - alignStats->mark).count ();
+    alignStats->mark = now;
+
+    if (phase == STATS_TRACE)
+    {
+      alignStats->traced = true;
+    }
+  } // end if keeping stats
+
+} // end statsLap function
+
+  // statsCells function:
+  // counts "cells" more cells filled
+
+static inline void statsCells (long long cells)
+{
+  if (alignStats != NULL)
+  {
+    alignStats->cells += cells;
+  }
+
+} // end statsCells function
+
+  // statsBytes function:
+  // the DP tables held "bytes" at their most (dpArena::peak)
+
+static inline void statsBytes (size_t bytes)
+{
+  if (alignStats != NULL && bytes > alignStats->dpBytes)
+  {
+    alignStats->dpBytes = bytes;
+  }
+
+} // end statsBytes function
+
+  // peakKB function:
+  // most memory held since resetPeak (bench.cpp), in kB
+  // (VmHWM, or the whole run if there is no /proc)
+
+long peakKB ()
+{
+  ifstream status ("/proc/self/status");
+  string theLine;
+
+  while (getline (status, theLine))
+  {
+    if (theLine.compare (0, 6, "VmHWM:") == 0)
+    {
+      return atol (theLine.c_str () + 6);
+    }
+  } // end while loop through the status
+
+  struct rusage usage;
+
+  getrusage (RUSAGE_SELF, &usage);
+
+  return usage.ru_maxrss;
+
+} // end peakKB function
+
+  // statsGcups function:
+  // giga cell updates per second of the fill, 0 if too fast to time
+
+double statsGcups (runStats &theStats)
+{
+  double fill = theStats.seconds[STATS_FILL];
+
+  return (fill > 0.0) ? theStats.cells / fill / 1e9 : 0.0;
+
+} // end statsGcups function
+
+  // printStats function:
+  // the timing and memory lines of the report
+
+void printStats (runStats &theStats)
+{
+  cout << fixed << setprecision (6);
+  cout << "parse: " << theStats.seconds[STATS_PARSE] << " s" << endl;
+  cout << "matrix init: " << theStats.seconds[STATS_INIT] << " s" << endl;
+  cout << "fill: " << theStats.seconds[STATS_FILL] << " s" << endl;
+
+  if (theStats.traced)
+  {
+    cout << "traceback: " << theStats.seconds[STATS_TRACE] << " s" << endl;
+  }
+  else
+  {
+    cout << "traceback: - (none apart from the fill)" << endl;
+  }
+
+  cout << "cells: " << theStats.cells << endl;
+  cout << setprecision (3) << "GCUPS: " << statsGcups (theStats) << endl;
+  cout << defaultfloat << setprecision (6);
+
+  if (theStats.dpBytes > 0)
+  {
+    cout << "DP memory: " << theStats.dpBytes << " bytes (";
+    cout << theStats.dpBytes / (1024 * 1024) << " MB)" << endl;
+  }
+  else
+  {
+    cout << "DP memory: - (a few rows)" << endl;
+  }
+
+  cout << "peak RSS: " << peakKB () << " kB" << endl << endl;
+
+} // end printStats function
+
+  // printStatsJson function:
+  // the stats, the alignment and its counts as one JSON line,
+  // appended to fileName ("-" = the console)
+  // method: how it was aligned ("table", "checkpoint", "banded", ...)
+  // returns false if the file can't be opened
+
+bool printStatsJson (string fileName, runStats &theStats, string dataFile,
+                      string mode, string method, int n, int m,
+                      int threads, int score, int matchCount,
+                      int mismatchCount, int gapCount, int openingGap)
+{
+  ofstream outFile;
+  ostream *out = &cout;
+
+  if (fileName != "-")
+  {
+    outFile.open (fileName, ios::app);
+
+    if (!outFile)
+    {
+      return false;
+    }
+
+    out = &outFile;
+  } // end if not the console
+
+  string name;
+
+  for (size_t c = 0; c < dataFile.length (); c++)
+  {
+    if (dataFile[c] == '"' || dataFile[c] == '\\')
+    {
+      name += '\\';
+    }
+
+    name += dataFile[c];
+  } // end escape the file name
+
+  *out << fixed << setprecision (6);
+  *out << "{\"file\": \"" << name << "\", \"mode\": \"" << mode << "\"";
+  *out << ", \"method\": \"" << method << "\"";
+  *out << ", \"n\": " << n << ", \"m\": " << m;
+  *out << ", \"threads\": " << threads << ", \"score\": " << score;
+  *out << ", \"parse_s\": " << theStats.seconds[STATS_PARSE];
+  *out << ", \"init_s\": " << theStats.seconds[STATS_INIT];
+  *out << ", \"fill_s\": " << theStats.seconds[STATS_FILL];
+  *out << ", \"trace_s\": ";
+
+  if (theStats.traced)
+  {
+    *out << theStats.seconds[STATS_TRACE];
+  }
+  else
+  {
+    *out << "null";
+  }
+
+  *out << ", \"cells\": " << theStats.cells;
+  *out << ", \"gcups\": " << setprecision (3) << statsGcups (theStats);
+  *out << ", \"dp_bytes\": ";
+
+  if (theStats.dpBytes > 0)
+  {
+    *out << theStats.dpBytes;
+  }
+  else
+  {
+    *out << "null";
+  }
+
+  *out << ", \"peak_rss_kb\": " << peakKB ();
+  *out << ", \"matches\": " << matchCount;
+  *out << ", \"mismatches\": " << mismatchCount;
+  *out << ", \"gaps\": " << gapCount;
+  *out << ", \"openingGaps\": " << openingGap << "}" << endl;
+  *out << defaultfloat << setprecision (6);
+
+  return true;
+
+} // end printStatsJson function
+
+#endif
@@ -0,0 +1,101 @@
+/*
+* Cpt_S 471
+* Programming Assignment #1
+*
+* scoreWidth.h
+*
+* Score widths for the SIMD kernels (stripedLocal.h, interSeq.h).
+* The narrower the score, the more of them fit in a vector: 8 bit
+* scores give twice the lanes of 16 bit ones.  The kernels are
+* templates on the vector type, start with 8 bit scores, and if a
+* score gets too big for that width they are run again with 16 bit
+* scores, then with plain ints (the scalar code).
+*
+*/
+
+#ifndef SCOREWIDTH_H
+#define SCOREWIDTH_H
+
+#include <limits>
+#include <type_traits>
+
+using namespace std;
+
+  // vector types (GCC vector extensions)
+  // 8 bit lanes
+
+typedef signed char v16qi __attribute__ ((vector_size (16)));
+typedef signed char v32qi __attribute__ ((vector_size (32)));
+typedef signed char v64qi __attribute__ ((vector_size (64)));
+
+  // 16 bit lanes
+
+typedef short v8hi __attribute__ ((vector_size (16)));
+typedef short v16hi __attribute__ ((vector_size (32)));
+typedef short v32hi __attribute__ ((vector_size (64)));
+
+  // scoreWidth: the limits of one lane of V
+  // minusInfinity is half way down the range, so a gap penalty
+  // (kept smaller than that) can be added to it without wrapping
+
+template <class V>
+struct scoreWidth
+{
+  typedef __typeof__ ( ( (V *) 0)[0][0]) score;
+
+  static int lanes ()
+  {
+    return sizeof (V) / sizeof (score);
+  }
+
+  static int bits ()
+  {
+    return sizeof (score) * 8;
+  }
+
+  static int low ()
+  {
+    return numeric_limits <score>::min ();
+  }
+
+  static int high ()
+  {
+    return numeric_limits <score>::max ();
+  }
+
+  static int minusInfinity ()
+  {
+    return numeric_limits <score>::min () / 2;
+  }
+};
+
+  // laneAdd function:
+  // a + b in every lane of V, held at the ends of the lane instead
+  // of wrapping around (the add is done unsigned, where wrapping is
+  // defined, and the lanes whose sign came out wrong are set to the
+  // end they ran past), so a lane that runs off its range stays
+  // off it for the checks that send the pair to wider scores
+  // (always inlined into a kernel built for its instruction set,
+  // so the -Wpsabi note on wide vector arguments doesn't apply)
+
+#pragma GCC diagnostic ignored "-Wpsabi"
+
+template <class V>
+static inline __attribute__ ((always_inline))
+V laneAdd (const V &a, const V &b)
+{
+  typedef typename scoreWidth <V>::score score;
+  typedef typename make_unsigned <score>::type bits;
+  typedef bits U __attribute__ ((vector_size (sizeof (V))));
+
+  V vZero = {};
+  V vSum = (V) ( (U) a + (U) b);
+  V vWrapped = ( (a ^ vSum) & (b ^ vSum) ) < vZero;
+  V vEnd = (a < vZero) ? vZero + (score) scoreWidth <V>::low ()
+                       : vZero + (score) scoreWidth <V>::high ();
+
+  return vWrapped ? vEnd : vSum;
+
+} // end laneAdd function
+
+#endif
@@ -0,0 +1,419 @@
+/*
+* Cpt_S 471
+* Programming Assignment #1
+*
+* scoring.h
+*
+* Substitution scores as a lookup table instead of S (a, b, match,
+* mismatch) in every cell.  The code of a character is its byte, so
+* every distinct character has its own code ('a' is not 'A', '-' is
+* not '.') and two of them match exactly when S1[i] == S2[j] would
+* say so; the table holds the score of every pair of codes, so a
+* cell is one load and no compare.
+*
+* The presets (DNA +1 / -1, transition / transversion, BLOSUM62) are
+* constexpr tables.  The kernels are templates on the scorer, so with
+* a preset the table is a constant the compiler can see; the table
+* from the parameter file (match / mismatch, or a matrix file) is
+* passed in at run time.  scoreDispatch picks the kernel.
+*
+* Parameter file:
+*   matrix dna | transition | blosum62 | <matrix file>
+* without a matrix line the table is built from match and mismatch.
+* A matrix file is in the NCBI format: '#' comment lines, a line with
+* the letters of the columns, then one row per letter.
+*
+*/
+
+#ifndef SCORING_H
+#define SCORING_H
+
+#include <string.h>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+using namespace std;
+
+#define SCORE_ALPHABET 256
+
+  // scoreKind: where the table came from
+  // SCORE_MATCH: match / mismatch from the parameter file
+  // SCORE_FILE: a matrix file
+
+#define SCORE_MATCH 0
+#define SCORE_DNA 1
+#define SCORE_TRANSITION 2
+#define SCORE_BLOSUM62 3
+#define SCORE_FILE 4
+
+  // scoreCode function:
+  // the code of a character, one per distinct byte
+
+constexpr int scoreCode (char c)
+{
+  return (unsigned char) c;
+
+} // end scoreCode function
+
+  // scoreTable: sub[a][b] = score of code a against code b
+
+struct scoreTable
+{
+  int sub[SCORE_ALPHABET][SCORE_ALPHABET];
+
+  constexpr const int *row (char a) const
+  {
+    return sub[scoreCode (a)];
+  }
+
+  constexpr int operator() (char a, char b) const
+  {
+    return sub[scoreCode (a)][scoreCode (b)];
+  }
+};
+
+  // matchTable function:
+  // match on the diagonal, mismatch everywhere else
+
+constexpr scoreTable matchTable (int match, int mismatch)
+{
+  scoreTable theTable = {};
+
+  for (int a = 0; a < SCORE_ALPHABET; a++)
+  {
+    for (int b = 0; b < SCORE_ALPHABET; b++)
+    {
+      theTable.sub[a][b] = (a == b) ? match : mismatch;
+    }
+  }
+
+  return theTable;
+
+} // end matchTable function
+
+  // transitionTable function:
+  // A <-> G and C <-> T (and a <-> g, c <-> t) score "transition",
+  // the other mismatches "transversion"
+
+constexpr scoreTable transitionTable (int match, int transition,
+                                      int transversion)
+{
+  scoreTable theTable = matchTable (match, transversion);
+  const char *pairs = "AGCTagct";
+
+  for (int k = 0; k < 8; k += 2)
+  {
+    int a = scoreCode (pairs[k]), b = scoreCode (pairs[k+1]);
+
+    theTable.sub[a][b] = transition;
+    theTable.sub[b][a] = transition;
+  }
+
+  return theTable;
+
+} // end transitionTable function
+
+  // BLOSUM62, rows and columns in the order of BLOSUM62_LETTERS
+
+#define BLOSUM62_LETTERS "ARNDCQEGHILKMFPSTWYVBZX*"
+
+constexpr int BLOSUM62_SCORES[24][24] =
+{
+  { 4,-1,-2,-2, 0,-1,-1, 0,-2,-1,-1,-1,-1,-2,-1, 1, 0,-3,-2, 0,-2,-1, 0,-4},
+  {-1, 5, 0,-2,-3, 1, 0,-2, 0,-3,-2, 2,-1,-3,-2,-1,-1,-3,-2,-3,-1, 0,-1,-4},
+  {-2, 0, 6, 1,-3, 0, 0, 0, 1,-3,-3, 0,-2,-3,-2, 1, 0,-4,-2,-3, 3, 0,-1,-4},
+  {-2,-2, 1, 6,-3, 0, 2,-1,-1,-3,-4,-1,-3,-3,-1, 0,-1,-4,-3,-3, 4, 1,-1,-4},
+  { 0,-3,-3,-3, 9,-3,-4,-3,-3,-1,-1,-3,-1,-2,-3,-1,-1,-2,-2,-1,-3,-3,-2,-4},
+  {-1, 1, 0, 0,-3, 5, 2,-2, 0,-3,-2, 1, 0,-3,-1, 0,-1,-2,-1,-2, 0, 3,-1,-4},
+  {-1, 0, 0, 2,-4, 2, 5,-2, 0,-3,-3, 1,-2,-3,-1, 0,-1,-3,-2,-2, 1, 4,-1,-4},
+  { 0,-2, 0,-1,-3,-2,-2, 6,-2,-4,-4,-2,-3,-3,-2, 0,-2,-2,-3,-3,-1,-2,-1,-4},
+  {-2, 0, 1,-1,-3, 0, 0,-2, 8,-3,-3,-1,-2,-1,-2,-1,-2,-2, 2,-3, 0, 0,-1,-4},
+  {-1,-3,-3,-3,-1,-3,-3,-4,-3, 4, 2,-3, 1, 0,-3,-2,-1,-3,-1, 3,-3,-3,-1,-4},
+  {-1,-2,-3,-4,-1,-2,-3,-4,-3, 2, 4,-2, 2, 0,-3,-2,-1,-2,-1, 1,-4,-3,-1,-4},
+  {-1, 2, 0,-1,-3, 1, 1,-2,-1,-3,-2, 5,-1,-3,-1, 0,-1,-3,-2,-2, 0, 1,-1,-4},
+  {-1,-1,-2,-3,-1, 0,-2,-3,-2, 1, 2,-1, 5, 0,-2,-1,-1,-1,-1, 1,-3,-1,-1,-4},
+  {-2,-3,-3,-3,-2,-3,-3,-3,-1, 0, 0,-3, 0, 6,-4,-2,-2, 1, 3,-1,-3,-3,-1,-4},
+  {-1,-2,-2,-1,-3,-1,-1,-2,-2,-3,-3,-1,-2,-4, 7,-1,-1,-4,-3,-2,-2,-1,-2,-4},
+  { 1,-1, 1, 0,-1, 0, 0, 0,-1,-2,-2, 0,-1,-2,-1, 4, 1,-3,-2,-2, 0, 0, 0,-4},
+  { 0,-1, 0,-1,-1,-1,-1,-2,-2,-1,-1,-1,-1,-2,-1, 1, 5,-2,-2, 0,-1,-1, 0,-4},
+  {-3,-3,-4,-4,-2,-2,-3,-2,-2,-3,-2,-3,-1, 1,-4,-3,-2,11, 2,-3,-4,-3,-2,-4},
+  {-2,-2,-2,-3,-2,-1,-2,-3, 2,-1,-1,-2,-1, 3,-3,-2,-2, 2, 7,-1,-3,-2,-1,-4},
+  { 0,-3,-3,-3,-1,-2,-2,-3,-3, 3, 1,-2, 1,-1,-2,-2, 0,-3,-1, 4,-3,-2,-1,-4},
+  {-2,-1, 3, 4,-3, 0, 1,-1, 0,-3,-4, 0,-3,-3,-2, 0,-1,-4,-3,-3, 4, 1,-1,-4},
+  {-1, 0, 0, 1,-3, 3, 4,-2, 0,-3,-3, 1,-1,-3,-1, 0,-1,-3,-2,-2, 1, 4,-1,-4},
+  { 0,-1,-1,-1,-2,-1,-1,-1,-1,-1,-1,-1,-1,-1,-2, 0, 0,-2,-1,-1,-1,-1,-1,-4},
+  {-4,-4,-4,-4,-4,-4,-4,-4,-4,-4,-4,-4,-4,-4,-4,-4,-4,-4,-4,-4,-4,-4,-4, 1}
+};
+
+  // blosum62Table function:
+  // characters that are not one of the 24 letters (J, O, U, lower
+  // case, anything else) score the same as X
+
+constexpr scoreTable blosum62Table ()
+{
+  scoreTable theTable = {};
+  int row[SCORE_ALPHABET] = {};
+  const char *letters = BLOSUM62_LETTERS;
+
+  for (int a = 0; a < SCORE_ALPHABET; a++)
+  {
+    row[a] = 22;
+  }
+
+  for (int k = 0; k < 24; k++)
+  {
+    row[scoreCode (letters[k])] = k;
+  }
+
+  for (int a = 0; a < SCORE_ALPHABET; a++)
+  {
+    for (int b = 0; b < SCORE_ALPHABET; b++)
+    {
+      theTable.sub[a][b] = BLOSUM62_SCORES[row[a]][row[b]];
+    }
+  }
+
+  return theTable;
+
+} // end blosum62Table function
+
+  // the presets
+
+constexpr scoreTable DNA_TABLE = matchTable (1, -1);
+constexpr scoreTable TRANSITION_TABLE = transitionTable (1, -1, -2);
+constexpr scoreTable BLOSUM62_TABLE = blosum62Table ();
+
+  // scorers, what the kernels are templates on:
+  // row (a) = the scores of a against every code,
+  // score (a, b) = row (a)[scoreCode (b)]
+
+template <const scoreTable &TABLE>
+struct presetScore
+{
+  const int *row (char a) const
+  {
+    return TABLE.row (a);
+  }
+
+  int operator() (char a, char b) const
+  {
+    return TABLE (a, b);
+  }
+};
+
+struct tableScore
+{
+  const scoreTable *table;
+
+  tableScore (const scoreTable *theTable = NULL)
+  {
+    table = theTable;
+  }
+
+  const int *row (char a) const
+  {
+    return table->row (a);
+  }
+
+  int operator() (char a, char b) const
+  {
+    return (*table) (a, b);
+  }
+};
+
+  // scoreScheme: the scoring one run uses
+  // match / mismatch are only meaningful if matchOnly (), the
+  // inter-sequence lanes can only do that kind of scoring
+  // high / low: the highest and lowest score in the table
+
+struct scoreScheme
+{
+  int kind;
+  string name;
+  int match;
+  int mismatch;
+  int high;
+  int low;
+  scoreTable table;
+
+  bool matchOnly ()
+  {
+    return (kind == SCORE_MATCH) || (kind == SCORE_DNA);
+  }
+};
+
+  // readMatrixFile function:
+  // reads a matrix in the NCBI format into theTable, codes
+  // missing from the file score the same as the first letter
+  // of the file against them would (so nothing is left unset)
+  // returns false if the file can't be read
+
+bool readMatrixFile (string fileName, scoreTable *theTable)
+{
+  ifstream inFile (fileName);
+  string theLine;
+  vector <char> columns;
+  bool seen[SCORE_ALPHABET] = {};
+  int rows = 0;
+
+  if (!inFile)
+  {
+    return false;
+  }
+
+  while (getline (inFile, theLine))
+  {
+    istringstream words (theLine);
+    string word;
+
+    if (theLine.length () == 0 || theLine[0] == '#')
+    {
+      continue;
+    }
+
+    if (columns.empty ())
+    {
+      while (words >> word)
+      {
+        columns.push_back (word[0]);
+      }
+
+      continue;
+    } // end if the line with the column letters
+
+    if (!(words >> word))
+    {
+      continue;
+    }
+
+    int a = scoreCode (word[0]);
+    int value = 0;
+
+    for (int k = 0; k < (int) columns.size () && (words >> value); k++)
+    {
+      theTable->sub[a][scoreCode (columns[k])] = value;
+    }
+
+    seen[a] = true;
+    rows++;
+
+  } // end while loop through the file
+
+  if (rows == 0)
+  {
+    return false;
+  }
+
+  int fill = scoreCode (columns[0]);
+
+  for (int a = 0; a < SCORE_ALPHABET; a++)
+  {
+    if (!seen[a])
+    {
+      for (int b = 0; b < SCORE_ALPHABET; b++)
+      {
+        theTable->sub[a][b] = theTable->sub[fill][b];
+        theTable->sub[b][a] = theTable->sub[fill][b];
+      }
+    }
+  } // end fill in the codes the file has no row for
+
+  return true;
+
+} // end readMatrixFile function
+
+  // setScoring function:
+  // fills in scoring from the "matrix" line of the parameter file
+  // ("" = match / mismatch)
+  // returns false if the matrix file can't be read
+
+bool setScoring (scoreScheme *scoring, string matrix, int match, int mismatch)
+{
+  scoring->name = matrix;
+  scoring->match = match;
+  scoring->mismatch = mismatch;
+
+  if (matrix == "")
+  {
+    scoring->kind = SCORE_MATCH;
+    scoring->name = "match / mismatch";
+    scoring->table = matchTable (match, mismatch);
+  }
+  else if (matrix == "dna")
+  {
+    scoring->kind = SCORE_DNA;
+    scoring->match = 1;
+    scoring->mismatch = -1;
+    scoring->table = DNA_TABLE;
+  }
+  else if (matrix == "transition")
+  {
+    scoring->kind = SCORE_TRANSITION;
+    scoring->table = TRANSITION_TABLE;
+  }
+  else if (matrix == "blosum62")
+  {
+    scoring->kind = SCORE_BLOSUM62;
+    scoring->table = BLOSUM62_TABLE;
+  }
+  else
+  {
+    scoring->kind = SCORE_FILE;
+    scoring->table = matchTable (0, 0);
+
+    if (!readMatrixFile (matrix, &scoring->table))
+    {
+      return false;
+    }
+  }
+
+  scoring->high = scoring->table.sub[0][0];
+  scoring->low = scoring->table.sub[0][0];
+
+  for (int a = 0; a < SCORE_ALPHABET; a++)
+  {
+    for (int b = 0; b < SCORE_ALPHABET; b++)
+    {
+      if (scoring->table.sub[a][b] > scoring->high)
+      {
+        scoring->high = scoring->table.sub[a][b];
+      }
+      if (scoring->table.sub[a][b] < scoring->low)
+      {
+        scoring->low = scoring->table.sub[a][b];
+      }
+    }
+  } // end find the highest and lowest score
+
+  return true;
+
+} // end setScoring function
+
+  // scoreDispatch function:
+  // calls body with the scorer for "scoring": a preset scorer
+  // (compile time table) if it is one, else the run time table
+
+template <class F>
+auto scoreDispatch (scoreScheme &scoring, F body)
+  -> decltype (body (tableScore (NULL)))
+{
+  if (scoring.kind == SCORE_DNA)
+  {
+    return body (presetScore <DNA_TABLE> ());
+  }
+  else if (scoring.kind == SCORE_TRANSITION)
+  {
+    return body (presetScore <TRANSITION_TABLE> ());
+  }
+  else if (scoring.kind == SCORE_BLOSUM62)
+  {
+    return body (presetScore <BLOSUM62_TABLE> ());
+  }
+
+  return body (tableScore (&scoring.table));
+
+} // end scoreDispatch function
+
+#endif
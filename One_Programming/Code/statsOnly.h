@@ -0,0 +1,382 @@
+/*
+* Cpt_S 471
+* Programming Assignment #1
+*
+* statsOnly.h
+*
+* The score and the counts of the report (matches, mismatches, gaps,
+* opening gaps, and where the alignment starts and ends) without the
+* table or the backtrace: one pass over two rows, every cell carrying,
+* for each of its three states, the counts of the path the backtrace
+* would take from there.
+*
+* The cells are worked out by globalCell / localCell (wavefront.h),
+* so the codes are the ones the table would hold, and each state
+* takes its counts from the cell and state tracePath (traceback.h)
+* would step to from those codes: the substitution from the best
+* state up-left, a gap from the same gap above / to the left if its
+* extend bit is set, else from the best state there (or the state
+* the open bits say, if that is the same gap).  The counts at
+* the end are then those of the alignment runGlobal / runLocal /
+* runSemiGlobal would print, ties and all.  The zeroeth row and
+* column carry the gaps the backtrace runs along there (or nothing,
+* where it stops).
+*
+* One pass in O(n + m) memory, about 100 bytes a row and a column
+* (BRCA2: 6 MB where the table takes 70), no backtrace.  A cell does
+* about three times the work of a table cell, so the pass takes
+* about twice the time of the table fill; it runs in strips of
+* columns two rows of which fit in the L1 cache, each strip reading
+* the column the one before it left, as the tiles of wavefront.h do.
+* The alignment itself is never known, so there is nothing to print
+* but the counts.
+*
+*/
+
+#ifndef STATSONLY_H
+#define STATSONLY_H
+
+#include <string.h>
+#include <unistd.h>
+#include <iostream>
+#include <vector>
+#include "alignCore.h"
+#include "traceback.h"
+#include "cigar.h"
+#include "wavefront.h"
+#include "scoring.h"
+#include "runStats.h"
+
+using namespace std;
+
+  // countCell: the counts of the path ending in one state of a cell
+  // last: the state of its last column, -1 if it has none
+  // startI / startJ: where it starts (0 based, as in alignResult)
+
+struct countCell
+{
+  int matchCount;
+  int mismatchCount;
+  int gapCount;
+  int openingGap;
+  int last;
+  int startI;
+  int startJ;
+};
+
+  // statsCell: a cell of the pass, its scores, its best state (the
+  // traceback code's, TRACE_ZERO where a local alignment starts after
+  // it) and the counts of each state
+
+struct statsCell
+{
+  ADP_cell score;
+  int state;
+  countCell count[3];
+};
+
+  // emptyCount function:
+  // a path with no columns that starts after T(i,j)
+
+static inline countCell emptyCount (int i, int j)
+{
+  countCell theCount = { 0, 0, 0, 0, -1, i, j };
+
+  return theCount;
+
+} // end emptyCount function
+
+  // countFrom function:
+  // the counts of "state" in T(i,j), as the backtrace steps to it
+
+static inline countCell countFrom (statsCell &cell, int state, int i, int j)
+{
+  return (state == TRACE_ZERO) ? emptyCount (i, j) : cell.count[state];
+
+} // end countFrom function
+
+  // statsEdge function:
+  // T(i,j) in the zeroeth row or column (edgeCell) with the gaps the
+  // backtrace takes from there back to T(0,0), the same for every state
+  // (local, semi-global's zeroeth row and T(0,0): none, it stops)
+
+static statsCell statsEdge (int i, int j, int g, int h, int mode)
+{
+  statsCell theCell;
+  countCell path = emptyCount (i, j);
+  bool gaps = (mode != ALIGN_LOCAL) &&
+              ( (j == 0) ? (i > 0) : (mode == ALIGN_GLOBAL) );
+
+  if (gaps)
+  {
+    path.gapCount = i + j;
+    path.openingGap = 1;
+    path.last = (j == 0) ? 1 : 2;
+    path.startI = 0;
+    path.startJ = 0;
+  } // end if a run of gaps
+
+  theCell.score = edgeCell (i, j, g, h, mode);
+  theCell.state = 0;
+  theCell.count[0] = path;
+  theCell.count[1] = path;
+  theCell.count[2] = path;
+
+  return theCell;
+
+} // end statsEdge function
+
+  // statsStep function:
+  // T(i,j) from the cells up-left (diag), up and left, its scores as
+  // globalCell / localCell, the counts as the backtrace would find them
+  // same: S1[i-1] is S2[j-1]
+
+static inline void statsStep (statsCell &diag, statsCell &up, statsCell &left,
+                              int i, int j, bool same, int score,
+                              int g, int h, bool local, statsCell &cell)
+{
+  int code = local ?
+             localCell (diag.score, up.score, left.score, score, g, h,
+                        cell.score) :
+             globalCell (diag.score, up.score, left.score, score, g, h,
+                         cell.score);
+  countCell theCount;
+  int from = 0;
+
+  cell.state = code & TRACE_STATE;
+
+    // substitution: from the best state up-left
+
+  theCount = countFrom (diag, diag.state, i - 1, j - 1);
+  theCount.matchCount += same;
+  theCount.mismatchCount += !same;
+  theCount.last = 0;
+  cell.count[0] = theCount;
+
+    // deletion: the one above goes on, or a new one after its best
+    // (after its substitution or insertion if the best is a deletion)
+
+  from = (up.state == 1) ? ( (code & TRACE_DEL_FROM_INS) ? 2 : 0 )
+                         : up.state;
+  theCount = (code & TRACE_DEL_EXTEND) ? up.count[1] :
+             countFrom (up, from, i - 1, j);
+  theCount.gapCount++;
+  theCount.openingGap += (theCount.last != 1);
+  theCount.last = 1;
+  cell.count[1] = theCount;
+
+    // insertion: the one to the left goes on, or a new one
+
+  from = (left.state == 2) ? ( (code & TRACE_INS_FROM_DEL) ? 1 : 0 )
+                           : left.state;
+  theCount = (code & TRACE_INS_EXTEND) ? left.count[2] :
+             countFrom (left, from, i, j - 1);
+  theCount.gapCount++;
+  theCount.openingGap += (theCount.last != 2);
+  theCount.last = 2;
+  cell.count[2] = theCount;
+
+} // end statsStep function
+
+  // statsStrip function:
+  // columns of S2 a strip of the pass takes: two rows of it fit in
+  // the L1 data cache (--tile sets it, as for the table)
+
+int statsStrip ()
+{
+  long l1 = 0;
+
+  if (wavefrontTileSize > 0)
+  {
+    return wavefrontTileSize;
+  }
+
+#ifdef _SC_LEVEL1_DCACHE_SIZE
+  l1 = sysconf (_SC_LEVEL1_DCACHE_SIZE);
+#endif
+
+  if (l1 <= 0)
+  {
+    l1 = WAVEFRONT_DEFAULT_L1;
+  }
+
+  int strip = l1 / (2 * sizeof (statsCell));
+
+  return (strip < WAVEFRONT_MIN_TILE) ? WAVEFRONT_MIN_TILE : strip;
+
+} // end statsStrip function
+
+  // statsFill function:
+  // the pass itself, for the scorer "sub", a strip of columns at a
+  // time from the top down, each strip reading the column the one
+  // before it left in "side"; the end and its counts go in result
+  // (no CIGAR)
+  // returns the optimal score
+
+template <class SCORER>
+static int statsFill (string &S1, string &S2, const SCORER &sub, int g, int h,
+                      int mode, alignResult &result)
+{
+  int n = S1.size () + 1;
+  int m = S2.size () + 1;
+  int strip = statsStrip ();
+  bool local = (mode == ALIGN_LOCAL);
+  vector <statsCell> side (n), lastRow (m);
+  vector <statsCell> prevRow (strip + 1), curRow (strip + 1);
+  vector <unsigned char> code2 (m);
+  int highScore = 0, endI = 0, endJ = 0;
+  countCell best = emptyCount (0, 0);
+
+  for (int i = 0; i < n; i++)
+  {
+    side[i] = statsEdge (i, 0, g, h, mode);
+  }
+
+  for (int j = 1; j < m; j++)
+  {
+    code2[j] = scoreCode (S2[j-1]);
+  } // end encode S2 once
+
+  lastRow[0] = side[n-1];
+
+  for (int colStart = 1; colStart < m; colStart += strip)
+  {
+    int colEnd = (colStart + strip < m) ? colStart + strip : m;
+    int width = colEnd - colStart + 1;
+    int stripScore = 0, stripI = 0, stripJ = 0;
+    countCell stripBest = best;
+
+    for (int b = 0; b < width; b++)
+    {
+      prevRow[b] = statsEdge (0, colStart - 1 + b, g, h, mode);
+    }
+
+    for (int i = 1; i < n; i++)
+    {
+      const int *subRow = sub.row (S1[i-1]);
+
+      curRow[0] = side[i];
+
+      for (int b = 1; b < width; b++)
+      {
+        int j = colStart - 1 + b;
+
+        statsStep (prevRow[b-1], prevRow[b], curRow[b-1], i, j,
+                   (S1[i-1] == S2[j-1]), subRow[code2[j]], g, h, local,
+                   curRow[b]);
+
+        if (local && curRow[b].score.sub_score > stripScore)
+        {
+          stripScore = curRow[b].score.sub_score;
+          stripI = i;
+          stripJ = j;
+          stripBest = curRow[b].count[0];
+        } // end if the first cell of the strip with a higher score
+      } // end for each column of the strip
+
+      side[i] = curRow[width - 1];
+      prevRow.swap (curRow);
+
+    } // end for each row
+
+    for (int b = 1; b < width; b++)
+    {
+      lastRow[colStart - 1 + b] = prevRow[b];
+    }
+
+      // ties go to the cell that comes first row by row
+
+    if ( (stripScore > highScore) ||
+         ( (stripScore == highScore) && (stripScore > 0) &&
+           ( (stripI < endI) || ( (stripI == endI) && (stripJ < endJ) ) ) ) )
+    {
+      highScore = stripScore;
+      endI = stripI;
+      endJ = stripJ;
+      best = stripBest;
+    } // end if a better (or earlier) local score
+
+  } // end for each strip
+
+  if (mode == ALIGN_SEMIGLOBAL)
+  {
+    endI = n - 1;
+
+    for (int j = 0; j < m; j++)
+    {
+      if (j == 0 || cellMax (lastRow[j].score) > highScore)
+      {
+        highScore = cellMax (lastRow[j].score);
+        endJ = j;
+      }
+    } // end for each cell of the last row, the first best
+
+    best = lastRow[endJ].count[maxState (lastRow[endJ].score)];
+  } // end if semi-global
+  else if (!local)
+  {
+    endI = n - 1;
+    endJ = m - 1;
+    highScore = cellMax (lastRow[endJ].score);
+    best = lastRow[endJ].count[lastRow[endJ].state];
+  } // end else if global
+
+  if (local && highScore <= 0)
+  {
+    endI = 0;
+    endJ = 0;
+    best = emptyCount (0, 0);
+  } // end if local with nothing above 0, an empty alignment
+
+  result.cigar.clear ();
+  result.score = highScore;
+  result.startI = best.startI;
+  result.startJ = best.startJ;
+  result.endI = endI;
+  result.endJ = endJ;
+  result.matchCount = best.matchCount;
+  result.mismatchCount = best.mismatchCount;
+  result.gapCount = best.gapCount;
+  result.openingGap = best.openingGap;
+  result.columns = best.matchCount + best.mismatchCount + best.gapCount;
+
+  return highScore;
+
+} // end statsFill function
+
+  // alignStatsOnly function:
+  // global, local or semi-global (mode) alignment of S1 and S2 down to
+  // its score, counts, start and end (result, with no CIGAR), in O(m)
+  // memory; the same numbers alignPair would give
+  // the fill and its cells go to alignStats (runStats.h)
+  // returns the optimal score (also in result.score)
+
+int alignStatsOnly (string &S1, string &S2, scoreScheme &scoring, int g,
+                     int h, int mode, alignResult &result)
+{
+  int score = 0;
+
+  statsMark ();
+
+  if (mode == ALIGN_SEMIGLOBAL && S1.size () == 0)
+  {
+    cigarPath empty = cigarStart (S1, S2, result, 0, 0);
+
+    cigarFinish (empty, result);
+    result.score = 0;
+    return 0;
+  } // end if an empty read, an empty alignment, as alignPair
+
+  score = scoreDispatch (scoring, [&] (auto sub)
+  {
+    return statsFill (S1, S2, sub, g, h, mode, result);
+  });
+
+  statsCells ( (long long) S1.size () * S2.size ());
+  statsLap (STATS_FILL);
+
+  return score;
+
+} // end alignStatsOnly function
+
+#endif
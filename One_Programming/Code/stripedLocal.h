@@ -0,0 +1,579 @@
+/*
+* Cpt_S 471
+* Programming Assignment #1
+*
+* stripedLocal.h
+*
+* Score-only local alignment with a striped SIMD kernel
+* (Farrar, "Striped Smith-Waterman speeds database searches
+* six times over other SIMD implementations", 2007)
+*
+* S2 is cut into L interleaved stripes, so lane l of vector k holds
+* position k + l * segLen.  That way the deletion and substitution
+* scores of a whole row come straight out of the row above, and only
+* the insertion scores need a second, usually short, "lazy F" pass
+* (at most one trip through the segments).
+* Scores are 8 bit first (64 lanes with AVX-512, 32 with AVX2, 16
+* with SSE4.1); if the score gets too big for that, the kernel runs
+* again with 16 bit scores and half the lanes (scoreWidth.h).
+*
+* This gives the same score and the same end position as the
+* runLocal table (the first cell, row by row, with the highest
+* substitution score).  The kernel opens a gap from the best score
+* H of the cell before it, where localCell opens a deletion after
+* the substitution or insertion only; with h <= 0 the two come to
+* the same scores (reopening a gap never beats extending it), so
+* the kernel only runs for h <= 0 (stripedFits).  If the CPU has
+* none of these instruction sets, h > 0, or the score gets too big
+* for 16 bits, the scalar version below (localCell itself) runs.
+*
+*/
+
+#ifndef STRIPEDLOCAL_H
+#define STRIPEDLOCAL_H
+
+#include <string.h>
+#include <iostream>
+#include <vector>
+#include <stdlib.h>
+#include "alignCore.h"
+#include "wavefront.h"
+#include "scoreWidth.h"
+#include "scoring.h"
+
+using namespace std;
+
+  // localScalarFill function:
+  // the runLocal cells (localCell, wavefront.h) with two rows
+  // instead of the full table,
+  // returns the high score and its position (row endI in S1,
+  // column endJ in S2, counting from 1)
+  // sub: the substitution scorer (scoring.h)
+
+template <class SCORER>
+int localScalarFill (string &S1, string &S2, const SCORER &sub,
+                      int g, int h, int *endI, int *endJ)
+{
+  int n = S1.size () + 1;
+  int m = S2.size () + 1;
+  int i = 0, j = 0;
+  int highScore = 0;
+
+  vector <ADP_cell> prevRow (m);
+  vector <ADP_cell> curRow (m);
+
+  *endI = 0;
+  *endJ = 0;
+
+  for (j = 0; j < m; j++)
+  {
+    prevRow[j].sub_score = 0;
+    prevRow[j].del_score = 0;
+    prevRow[j].ins_score = 0;
+  } // end initialize row 0
+
+  curRow[0] = prevRow[0];
+
+  for (i = 1; i < n; i++)
+  {
+    const int *subRow = sub.row (S1[i-1]);
+
+    for (j = 1; j < m; j++)
+    {
+      localCell (prevRow[j-1], prevRow[j], curRow[j-1],
+                 subRow[scoreCode (S2[j-1])], g, h, curRow[j]);
+
+      if (curRow[j].sub_score > highScore)
+      {
+        highScore = curRow[j].sub_score;
+        *endI = i;
+        *endJ = j;
+      } // end if we have found a higher score, record its position
+
+    } // end inner loop
+
+    prevRow.swap (curRow);
+
+  } // end outer loop
+
+  return highScore;
+
+} // end localScalarFill function
+
+  // localScoreScalar function:
+  // localScalarFill for the scorer of "scoring"
+
+int localScoreScalar (string &S1, string &S2, scoreScheme &scoring,
+                       int g, int h, int *endI, int *endJ)
+{
+  return scoreDispatch (scoring, [&] (auto sub)
+  {
+    return localScalarFill (S1, S2, sub, g, h, endI, endJ);
+  });
+
+} // end localScoreScalar function
+
+  // stripedBuffer: an array of vectors on a 64 byte boundary
+  // (std::vector does not promise the alignment the AVX2 loads need)
+
+template <class V>
+struct stripedBuffer
+{
+  V *data;
+
+  stripedBuffer (int count)
+  {
+    void *theMemory = NULL;
+
+    if (posix_memalign (&theMemory, 64, sizeof (V) * (count > 0 ? count : 1)) != 0)
+    {
+      theMemory = NULL;
+    }
+
+    data = (V *) theMemory;
+  }
+
+  ~stripedBuffer ()
+  {
+    free (data);
+  }
+
+  V &operator[] (int index)
+  {
+    return data[index];
+  }
+};
+
+  // the helpers below pass vectors by value but are always inlined
+  // into a function compiled for AVX2 / SSE4.1, so the warning about
+  // the calling convention of 32 byte vectors does not apply
+
+#pragma GCC diagnostic ignored "-Wpsabi"
+
+  // stripedMax: lane by lane maximum
+
+template <class V>
+static inline __attribute__ ((always_inline))
+V stripedMax (const V &a, const V &b)
+{
+  return a > b ? a : b;
+}
+
+  // stripedShift: move every lane up one, lane 0 gets "fill"
+
+static inline __attribute__ ((always_inline))
+v16qi stripedShift (const v16qi &a, const v16qi &fill)
+{
+  return __builtin_shuffle (a, fill,
+            (v16qi) {16, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14});
+}
+
+static inline __attribute__ ((always_inline))
+v32qi stripedShift (const v32qi &a, const v32qi &fill)
+{
+  return __builtin_shuffle (a, fill,
+            (v32qi) {32, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14,
+             15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30});
+}
+
+static inline __attribute__ ((always_inline))
+v64qi stripedShift (const v64qi &a, const v64qi &fill)
+{
+  return __builtin_shuffle (a, fill,
+            (v64qi) {64, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14,
+             15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30,
+             31, 32, 33, 34, 35, 36, 37, 38, 39, 40, 41, 42, 43, 44, 45, 46,
+             47, 48, 49, 50, 51, 52, 53, 54, 55, 56, 57, 58, 59, 60, 61, 62});
+}
+
+static inline __attribute__ ((always_inline))
+v8hi stripedShift (const v8hi &a, const v8hi &fill)
+{
+  return __builtin_shuffle (a, fill,
+            (v8hi) {8, 0, 1, 2, 3, 4, 5, 6});
+}
+
+static inline __attribute__ ((always_inline))
+v16hi stripedShift (const v16hi &a, const v16hi &fill)
+{
+  return __builtin_shuffle (a, fill,
+            (v16hi) {16, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14});
+}
+
+static inline __attribute__ ((always_inline))
+v32hi stripedShift (const v32hi &a, const v32hi &fill)
+{
+  return __builtin_shuffle (a, fill,
+            (v32hi) {32, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14,
+             15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30});
+}
+
+  // stripedAny: true if any lane of a is greater than that lane of b
+
+template <class V>
+static inline __attribute__ ((always_inline))
+bool stripedAny (const V &a, const V &b)
+{
+  V mask = a > b;
+  unsigned long long words[sizeof (V) / 8];
+  unsigned long long any = 0;
+
+  memcpy (words, &mask, sizeof (V));
+
+  for (unsigned int w = 0; w < sizeof (V) / 8; w++)
+  {
+    any |= words[w];
+  }
+
+  return any != 0;
+}
+
+  // stripedBody function:
+  // the striped kernel for one vector type, only ever inlined
+  // into stripedLocalAVX512 / stripedLocalAVX2 / stripedLocalSSE41
+  // so it is compiled for that instruction set
+  // returns -1 if the scores got too big for the lanes of V
+
+template <class V>
+static inline __attribute__ ((always_inline))
+int stripedBody (string &S1, string &S2, scoreScheme &scoring,
+                  int g, int h, int *endI, int *endJ)
+{
+  typedef typename scoreWidth <V>::score lane;
+  const int L = scoreWidth <V>::lanes ();
+  const int floor = scoreWidth <V>::minusInfinity ();
+  int n = S1.size ();
+  int qLen = S2.size ();
+  int segLen = (qLen + L - 1) / L;
+  int i = 0, j = 0, k = 0, l = 0, carry = 0;
+  int laneGap = (segLen < 65536 / (1 - g)) ? segLen * (-g) : 65536;
+  int best = 0, rowMax = 0;
+  int maxScore = scoring.high;
+  int limit = scoreWidth <V>::high () - (2 * maxScore);
+
+  V vZero = {};
+  V vGapO = vZero + (lane) (-(h + g));
+  V vGapE = vZero + (lane) (-g);
+  V vFloor = vZero + (lane) floor;
+  V vF, vH, vMax, vCarry;
+
+  *endI = 0;
+  *endJ = 0;
+
+  if (segLen == 0)
+  {
+    return 0;
+  } // end if S2 is empty
+
+    // query profile: for each character that shows up in S1,
+    // the score against every position of S2, in striped order
+    // (positions past the end of S2 get a score that keeps them at 0)
+
+  int profileIndex[256];
+  int profileCount = 0;
+
+  for (k = 0; k < 256; k++)
+  {
+    profileIndex[k] = -1;
+  }
+
+  for (i = 0; i < n; i++)
+  {
+    if (profileIndex[(unsigned char) S1[i]] < 0)
+    {
+      profileIndex[(unsigned char) S1[i]] = profileCount;
+      profileCount++;
+    }
+  } // end number the characters of S1
+
+  stripedBuffer <V> profile (profileCount * segLen);
+  stripedBuffer <V> HStore (segLen);
+  stripedBuffer <V> HLoad (segLen);
+  stripedBuffer <V> E (segLen);
+  stripedBuffer <V> bestRow (segLen);
+
+  if (profile.data == NULL || HStore.data == NULL ||
+      HLoad.data == NULL || E.data == NULL || bestRow.data == NULL)
+  {
+    return -1;
+  } // end if out of memory
+
+  for (int c = 0; c < 256; c++)
+  {
+    if (profileIndex[c] >= 0)
+    {
+      V *vP = &profile[profileIndex[c] * segLen];
+
+      for (k = 0; k < segLen; k++)
+      {
+        V vScore = vZero;
+
+        for (l = 0; l < L; l++)
+        {
+          j = k + (l * segLen);
+
+          if (j < qLen)
+          {
+            vScore[l] = scoring.table (c, S2[j]);
+          }
+          else
+          {
+            vScore[l] = floor;
+          }
+        } // end for each lane
+
+        vP[k] = vScore;
+
+      } // end for each segment
+
+    } // end if character is in S1
+
+  } // end build query profile
+
+  for (k = 0; k < segLen; k++)
+  {
+    HStore[k] = vZero;
+    E[k] = vZero;
+  }
+
+  for (i = 0; i < n; i++)
+  {
+    V *vP = &profile[profileIndex[(unsigned char) S1[i]] * segLen];
+
+    vF = vZero;
+    vMax = vZero;
+
+      // the cell up and to the left of segment 0 is the
+      // last segment of the row above, moved over one lane
+
+    vH = stripedShift (HStore[segLen - 1], vZero);
+
+    V *swapHold = HLoad.data;
+    HLoad.data = HStore.data;
+    HStore.data = swapHold;
+
+    for (k = 0; k < segLen; k++)
+    {
+      vH = vH + vP[k];
+      vH = stripedMax (vH, E[k]);
+      vH = stripedMax (vH, vF);
+      vH = stripedMax (vH, vZero);
+      vMax = stripedMax (vMax, vH);
+      HStore[k] = vH;
+
+        // scores for the next row (lane) and the next segment (F)
+
+      vH = vH - vGapO;
+      E[k] = stripedMax (E[k] - vGapE, vH);
+      vF = stripedMax (vF - vGapE, vH);
+
+      vH = HLoad[k];
+
+    } // end for each segment
+
+      // lazy F: carry insertions across the stripe boundaries
+      // the insertion leaving the end of lane l goes into the start
+      // of lane l + 1, so the carry into each lane is worked out
+      // first (in ints, one lane at a time), then one pass adds it
+      // in until it can no longer beat opening a new gap
+
+    carry = floor;
+
+    for (l = 0; l < L; l++)
+    {
+      vCarry[l] = (carry > floor) ? carry : floor;
+
+      carry = (carry - laneGap > floor) ? carry - laneGap : floor;
+      if (vF[l] > carry)
+      {
+        carry = vF[l];
+      }
+    } // end for each lane
+
+    vF = vCarry;
+    k = 0;
+
+    while ( (k < segLen) && stripedAny (vF, HStore[k] - vGapO) )
+    {
+      HStore[k] = stripedMax (HStore[k], vF);
+      E[k] = stripedMax (E[k], HStore[k] - vGapO);
+      vF = stripedMax (vF - vGapE, vFloor);
+
+      k++;
+
+    } // end lazy F loop
+
+      // a new high score: keep the row so the end column
+    // can be found once we are done
+
+    rowMax = 0;
+
+    for (l = 0; l < L; l++)
+    {
+      if (vMax[l] > rowMax)
+      {
+        rowMax = vMax[l];
+      }
+    } // end for each lane
+
+    if (rowMax > best)
+    {
+      best = rowMax;
+      *endI = i + 1;
+
+      for (k = 0; k < segLen; k++)
+      {
+        bestRow[k] = HStore[k];
+      } // end keep a copy of the row
+
+      if (best > limit)
+      {
+        return -1;
+      } // end if the next row could overflow 16 bits
+
+    } // end if new high score
+
+  } // end for each row
+
+    // the end column is the first column of the
+    // high score row that holds the high score
+
+  if (best > 0)
+  {
+    int firstJ = qLen;
+
+    for (k = 0; k < segLen; k++)
+    {
+      for (l = 0; l < L; l++)
+      {
+        j = k + (l * segLen);
+
+        if ( (bestRow[k][l] == best) && (j < firstJ) )
+        {
+          firstJ = j;
+        }
+      } // end for each lane
+    } // end for each segment
+
+    *endJ = firstJ + 1;
+
+  } // end if there is a high score
+
+  return best;
+
+} // end stripedBody function
+
+  // the striped kernel for each instruction set, V picks the
+  // score width (8 or 16 bit lanes)
+
+template <class V>
+__attribute__ ((target ("avx512bw")))
+int stripedLocalAVX512 (string &S1, string &S2, scoreScheme &scoring,
+                         int g, int h, int *endI, int *endJ)
+{
+  return stripedBody <V> (S1, S2, scoring, g, h, endI, endJ);
+}
+
+template <class V>
+__attribute__ ((target ("avx2")))
+int stripedLocalAVX2 (string &S1, string &S2, scoreScheme &scoring,
+                       int g, int h, int *endI, int *endJ)
+{
+  return stripedBody <V> (S1, S2, scoring, g, h, endI, endJ);
+}
+
+template <class V>
+__attribute__ ((target ("sse4.1")))
+int stripedLocalSSE41 (string &S1, string &S2, scoreScheme &scoring,
+                        int g, int h, int *endI, int *endJ)
+{
+  return stripedBody <V> (S1, S2, scoring, g, h, endI, endJ);
+}
+
+  // stripedFits function:
+  // true if the gap penalties and scores leave room for the
+  // kernel in lanes of V: gaps (h, g <= 0) that can be added to a
+  // score without wrapping around, substitution scores no lower
+  // than that, and a high score limit above 0
+
+template <class V>
+bool stripedFits (scoreScheme &scoring, int g, int h)
+{
+  int room = -scoreWidth <V>::minusInfinity ();
+  int maxScore = scoring.high;
+
+  return (h <= 0) && (g <= 0) && ( -h - (2 * g) <= room) &&
+         (scoring.low >= -room) &&
+         ( (maxScore <= 0) || (4 * maxScore < scoreWidth <V>::high ()) );
+
+} // end stripedFits function
+
+  // runLocalScore function:
+  // best local score and where it ends, using the widest
+  // striped kernel the CPU has, or the scalar version
+  // 8 bit scores first (twice the lanes), then 16 bit if the score
+  // got too big for that, then the scalar version (ints)
+  // kernel is set to the name of the kernel that was used
+
+int runLocalScore (string &S1, string &S2, scoreScheme &scoring,
+                    int g, int h, int *endI, int *endJ, string *kernel)
+{
+  int score = -1;
+
+  if (__builtin_cpu_supports ("avx512bw"))
+  {
+    if (stripedFits <v64qi> (scoring, g, h))
+    {
+      *kernel = "striped AVX-512, 8 bit";
+      score = stripedLocalAVX512 <v64qi> (S1, S2, scoring, g, h,
+                                          endI, endJ);
+    }
+    if (score < 0 && stripedFits <v32hi> (scoring, g, h))
+    {
+      *kernel = "striped AVX-512, 16 bit";
+      score = stripedLocalAVX512 <v32hi> (S1, S2, scoring, g, h,
+                                          endI, endJ);
+    }
+  } // end if AVX-512
+  else if (__builtin_cpu_supports ("avx2"))
+  {
+    if (stripedFits <v32qi> (scoring, g, h))
+    {
+      *kernel = "striped AVX2, 8 bit";
+      score = stripedLocalAVX2 <v32qi> (S1, S2, scoring, g, h,
+                                        endI, endJ);
+    }
+    if (score < 0 && stripedFits <v16hi> (scoring, g, h))
+    {
+      *kernel = "striped AVX2, 16 bit";
+      score = stripedLocalAVX2 <v16hi> (S1, S2, scoring, g, h,
+                                        endI, endJ);
+    }
+  } // end else if AVX2
+  else if (__builtin_cpu_supports ("sse4.1"))
+  {
+    if (stripedFits <v16qi> (scoring, g, h))
+    {
+      *kernel = "striped SSE4.1, 8 bit";
+      score = stripedLocalSSE41 <v16qi> (S1, S2, scoring, g, h,
+                                         endI, endJ);
+    }
+    if (score < 0 && stripedFits <v8hi> (scoring, g, h))
+    {
+      *kernel = "striped SSE4.1, 16 bit";
+      score = stripedLocalSSE41 <v8hi> (S1, S2, scoring, g, h,
+                                        endI, endJ);
+    }
+  } // end else if SSE4.1
+
+  if (score < 0)
+  {
+    *kernel = "scalar";
+    score = localScoreScalar (S1, S2, scoring, g, h, endI, endJ);
+  } // end if no striped result, use the scalar version
+
+  return score;
+
+} // end runLocalScore function
+
+#endif
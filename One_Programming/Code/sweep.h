@@ -0,0 +1,354 @@
+/*
+* Cpt_S 471
+* Programming Assignment #1
+*
+* sweep.h
+*
+* Parameter sweep: the batch pairs (batch.h) aligned once for every
+* scoring profile of a profile file, to tune the scoring without
+* reading and unpacking the records again for each one.  The file has
+* one profile per line (blank lines and lines starting with "#" are
+* skipped):
+*
+*   <name> <match> <mismatch> <h> <g> [matrix]
+*
+* with the matrix as in the parameter file (scoring.h).  The records
+* are unpacked once, and every (profile, pair) goes to the workers as
+* one job (with --lanes, every (profile, chunk of pairs)), so all of
+* the profiles run at once.  --screen is worked out by the worker
+* that first gets a pair, and kept for the other profiles.  What is
+* reused is the unpacking and the screening: each kernel still makes
+* its own copy of the codes of S2 (scoring.h, a code is the byte
+* itself, so that is a copy and no lookup).
+*
+* A line is printed as soon as its pair is done, as runBatch does, so
+* the lines of the profiles come mixed; only the totals of each
+* profile are kept, and printed, in the order of the file, at the
+* end.
+*
+*/
+
+#ifndef SWEEP_H
+#define SWEEP_H
+
+#include <string.h>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include "alignCore.h"
+#include "pairAlign.h"
+#include "interSeq.h"
+#include "batch.h"
+#include "cigar.h"
+#include "scoring.h"
+#include "../../Common/packedSeq.h"
+
+using namespace std;
+
+  // sweepProfile: one line of the profile file
+
+struct sweepProfile
+{
+  string name;
+  int match;
+  int mismatch;
+  int h;
+  int g;
+  string matrix;
+  scoreScheme scoring;
+};
+
+  // readProfiles function:
+  // reads the profiles of a profile file and sets up their scoring
+  // returns the number of profiles, -1 if the file can't be opened
+  // or a line can't be read (the line is printed)
+
+int readProfiles (string fileName, vector <sweepProfile> &profiles)
+{
+  ifstream inFile (fileName);
+  string theLine;
+
+  if (!inFile)
+  {
+    return -1;
+  }
+
+  while (getline (inFile, theLine))
+  {
+    istringstream fields (theLine);
+    sweepProfile theProfile;
+
+    if (!(fields >> theProfile.name) || theProfile.name[0] == '#')
+    {
+      continue;
+    } // end if blank or a comment
+
+    if (!(fields >> theProfile.match >> theProfile.mismatch >>
+                    theProfile.h >> theProfile.g))
+    {
+      cout << "Bad profile line: " << theLine << endl;
+      return -1;
+    } // end if not four numbers
+
+    fields >> theProfile.matrix;
+
+    if (!setScoring (&theProfile.scoring, theProfile.matrix,
+                     theProfile.match, theProfile.mismatch))
+    {
+      cout << "Unable to read matrix " << theProfile.matrix;
+      cout << " for profile " << theProfile.name << endl;
+      return -1;
+    } // end if no substitution matrix
+
+    profiles.push_back (theProfile);
+
+  } // end for each line
+
+  return profiles.size ();
+
+} // end readProfiles function
+
+  // sweepTotals: what the pairs of one profile add up to
+
+struct sweepTotals
+{
+  int pairs;
+  long long score;
+  long long columns;
+  long long matches;
+  long long mismatches;
+  long long gaps;
+  long long openings;
+};
+
+  // addToTotals function:
+  // adds one pair's result to the totals of its profile
+
+void addToTotals (sweepTotals &totals, alignResult &theResult)
+{
+  totals.pairs++;
+  totals.score += theResult.score;
+  totals.columns += theResult.columns;
+  totals.matches += theResult.matchCount;
+  totals.mismatches += theResult.mismatchCount;
+  totals.gaps += theResult.gapCount;
+  totals.openings += theResult.openingGap;
+
+} // end addToTotals function
+
+  // printProfileTotals function:
+  // the comment line with the totals of one profile over its pairs
+
+void printProfileTotals (sweepProfile &theProfile, sweepTotals &totals)
+{
+  cout << "# profile " << theProfile.name << " (match " << theProfile.match;
+  cout << ", mismatch " << theProfile.mismatch << ", h " << theProfile.h;
+  cout << ", g " << theProfile.g;
+
+  if (theProfile.matrix.length () > 0)
+  {
+    cout << ", matrix " << theProfile.scoring.name;
+  }
+
+  cout << "): pairs " << totals.pairs << ", score " << totals.score;
+  cout << ", mean score " << fixed << setprecision (2);
+  cout << ( (totals.pairs > 0) ? (double) totals.score / totals.pairs : 0.0);
+  cout << ", identity ";
+  cout << ( (totals.columns > 0) ? 100.0 * totals.matches / totals.columns
+                                 : 0.0) << "%";
+  cout << defaultfloat << setprecision (6);
+  cout << ", matches " << totals.matches << ", mismatches " << totals.mismatches;
+  cout << ", gaps " << totals.gaps << ", openingGaps " << totals.openings;
+  cout << endl;
+
+} // end printProfileTotals function
+
+  // runSweep function:
+  // runBatch / runBatchLanes (lanes: global only) for every profile,
+  // on "workers" threads, printing one line per profile and pair
+  // (the profile name, then the batch columns) as it finishes, and
+  // the totals of each profile at the end
+  // screen >= 0: pairs more than "screen" edits apart get no line
+  // budget: the memory of each worker (planner.h)
+  // returns the number of pairs
+
+int runSweep (vector <string> &qNames, vector <packedSeq> &qSeqs,
+               vector <string> &tNames, vector <packedSeq> &tSeqs,
+               bool allPairs, vector <sweepProfile> &profiles,
+               int mode, int workers, bool lanes, int screen,
+               size_t budget)
+{
+  vector <string> queries, targets;
+  vector <batchJob> pairs;
+  vector <thread> threads;
+  mutex printLock;
+  atomic <int> screened (0);
+  int profileCount = profiles.size ();
+
+  for (size_t r = 0; r < qSeqs.size (); r++)
+  {
+    queries.push_back (qSeqs[r].str ());
+  }
+
+  for (size_t r = 0; r < tSeqs.size (); r++)
+  {
+    targets.push_back (tSeqs[r].str ());
+  } // end unpack every record once
+
+  vector <string> &targetNames = allPairs ? qNames : tNames;
+  vector <string> &targetStrs = allPairs ? queries : targets;
+
+  for (int q = 0; q < (int) queries.size (); q++)
+  {
+    int tStart = allPairs ? q + 1 : 0;
+    int tEnd = allPairs ? queries.size () : targets.size ();
+
+    for (int t = tStart; t < tEnd; t++)
+    {
+      batchJob job;
+
+      job.query = q;
+      job.target = t;
+      pairs.push_back (job);
+    }
+  } // end for each query
+
+  int pairCount = pairs.size ();
+  int chunk = (lanes && mode == ALIGN_GLOBAL) ? BATCH_CHUNK : 1;
+  int chunkCount = (pairCount + chunk - 1) / chunk;
+  int jobCount = chunkCount * profileCount;
+  atomic <int> nextJob (0);
+  sweepTotals noPairs = { 0, 0, 0, 0, 0, 0, 0 };
+  vector <sweepTotals> totals (profileCount, noPairs);
+
+    // screenState[p]: 0 = not screened yet, 1 = kept, 2 = dropped;
+    // the worker that sets it counts the drop
+
+  atomic <int> *screenState = new atomic <int> [pairCount];
+
+  for (int p = 0; p < pairCount; p++)
+  {
+    screenState[p] = 0;
+  }
+
+  auto dropped = [&] (int p)
+  {
+    int state = screenState[p];
+
+    if (state == 0)
+    {
+      int expected = 0;
+
+      state = batchScreened (queries[pairs[p].query],
+                             targetStrs[pairs[p].target], screen) ? 2 : 1;
+
+      if (screenState[p].compare_exchange_strong (expected, state) &&
+          state == 2)
+      {
+        screened++;
+      }
+    } // end if no worker has screened it yet
+
+    return state == 2;
+  };
+
+  if (workers <= 0)
+  {
+    workers = 1;
+  }
+
+  cout << "# profile\tquery\ttarget\tscore\tcolumns\tmatches\tmismatches";
+  cout << "\tgaps\topeningGaps\tcigar" << endl;
+
+    // job u is chunk u / profileCount of profile u % profileCount,
+    // so the profiles of a chunk go one after another
+
+  for (int w = 0; w < workers; w++)
+  {
+    threads.push_back (thread ([&] ()
+    {
+      int u = 0;
+      dpArena arena (true);
+
+      while ( (u = nextJob++) < jobCount)
+      {
+        int f = u % profileCount;
+        sweepProfile &theProfile = profiles[f];
+        int start = (u / profileCount) * chunk;
+        int end = (start + chunk < pairCount) ? start + chunk : pairCount;
+        vector <int> kept;
+        vector <alignResult> theResults;
+
+        if (chunk == 1)
+        {
+          if (dropped (start))
+          {
+            continue;
+          }
+
+          theResults.resize (1);
+          kept.push_back (start);
+          alignPlanned (queries[pairs[start].query],
+                        targetStrs[pairs[start].target],
+                        theProfile.scoring, theProfile.g, theProfile.h,
+                        mode, budget, arena, theResults[0]);
+        } // end if one pair
+        else
+        {
+          vector <string> A, B;
+          string theKernel;
+
+          for (int p = start; p < end; p++)
+          {
+            if (!dropped (p))
+            {
+              A.push_back (queries[pairs[p].query]);
+              B.push_back (targetStrs[pairs[p].target]);
+              kept.push_back (p);
+            }
+          }
+
+          alignMany (A, B, theProfile.scoring, theProfile.g, theProfile.h,
+                     arena, theResults, &theKernel);
+        } // end else, a chunk in the lanes
+
+        unique_lock <mutex> hold (printLock);
+
+        for (size_t k = 0; k < kept.size (); k++)
+        {
+          int p = kept[k];
+
+          cout << theProfile.name << "\t" << qNames[pairs[p].query] << "\t";
+          cout << targetNames[pairs[p].target] << "\t";
+          printResultLine (theResults[k]);
+          addToTotals (totals[f], theResults[k]);
+        } // end for each pair done
+
+      } // end while there are jobs
+    }));
+  } // end start the workers
+
+  for (int w = 0; w < workers; w++)
+  {
+    threads[w].join ();
+  }
+
+  delete [] screenState;
+
+  for (int f = 0; f < profileCount; f++)
+  {
+    printProfileTotals (profiles[f], totals[f]);
+  }
+
+  printScreened (screen, screened);
+
+  return pairCount;
+
+} // end runSweep function
+
+#endif
@@ -0,0 +1,383 @@
+/*
+* Cpt_S 471
+* Programming Assignment #1
+*
+* topLocal.h
+*
+* The k best local alignments that share no cell (Waterman - Eggert).
+* The first one is the runLocal alignment.  After each one is found
+* its cells are taken out of the table (all three scores set to 0,
+* so nothing can run through them) and only the part of the table
+* that changes because of that is filled again:
+*
+*   - a row is redone from the first column that changed in the row
+*     above it (or its first taken cell), and stops at the first
+*     cell that comes out the same once it is past the column after
+*     the last one that changed above it (and its last taken cell)
+*   - the rows stop when a whole row comes out the same below the
+*     alignment
+*
+* Taking cells out only ever lowers scores, so each row keeps its
+* highest substitution score, and only a row whose highest cell went
+* down has to be looked through again.  The next alignment starts at
+* the highest of those, row by row first as in runLocal.
+*
+* This needs all three scores of every cell (12 bytes a cell, plus
+* the 4 bit traceback code and a bit for taken cells), all from one
+* dpArena, and fills on one thread.  The backtraces run between the
+* refills, so the stats (runStats.h) count them in the fill, and
+* the cells of the refills with those of the first fill.
+*
+*/
+
+#ifndef TOPLOCAL_H
+#define TOPLOCAL_H
+
+#include <string.h>
+#include <iostream>
+#include <vector>
+#include "alignCore.h"
+#include "traceback.h"
+#include "wavefront.h"
+#include "dpArena.h"
+#include "runStats.h"
+#include "scoring.h"
+
+using namespace std;
+
+  // localHit: one of the top alignments, S1[startI..endI - 1]
+  // against S2[startJ..endJ - 1] (0 based), left to right
+
+struct localHit
+{
+  int score;
+  int startI, startJ;
+  int endI, endJ;
+  vector <char> theS1;
+  vector <char> theS2;
+};
+
+  // topTable: the scores, codes and taken cells of the whole table
+
+struct topTable
+{
+  int n, m;
+  ADP_cell *cells;
+  unsigned char *taken;
+  traceMatrix T;
+  vector <int> rowBest;
+  vector <int> rowBestJ;
+
+  topTable (int theN, int theM, int h, dpArena &arena)
+    : T (theN, theM, h, arena)
+  {
+    n = theN;
+    m = theM;
+    cells = (ADP_cell *) arena.take ( (size_t) n * m * sizeof (ADP_cell));
+    taken = (unsigned char *) arena.take ( ( (size_t) n * m + 7) / 8);
+    rowBest.assign (n, 0);
+    rowBestJ.assign (n, 0);
+  }
+
+  bool ok ()
+  {
+    return cells != NULL && taken != NULL && (T.bits != NULL || n <= 1 || m <= 1);
+  }
+
+  ADP_cell &at (int i, int j)
+  {
+    return cells[ (size_t) i * m + j];
+  }
+
+  bool isTaken (int i, int j)
+  {
+    size_t k = (size_t) i * m + j;
+
+    return (taken[k / 8] >> (k % 8)) & 1;
+  }
+
+  void take (int i, int j)
+  {
+    size_t k = (size_t) i * m + j;
+
+    taken[k / 8] |= 1 << (k % 8);
+  }
+
+    // findRowBest: the first cell of row i with the highest
+    // substitution score
+
+  void findRowBest (int i)
+  {
+    rowBest[i] = 0;
+    rowBestJ[i] = 0;
+
+    for (int j = 1; j < m; j++)
+    {
+      if (at (i, j).sub_score > rowBest[i])
+      {
+        rowBest[i] = at (i, j).sub_score;
+        rowBestJ[i] = j;
+      }
+    }
+  }
+};
+
+  // topCell function:
+  // T(i,j) again from its neighbours, a taken cell is all 0
+  // returns the traceback code
+
+static inline int topCell (topTable &theTable, const int *subRow,
+                            unsigned char *code2, int i, int j,
+                            int g, int h, ADP_cell &cell)
+{
+  if (theTable.isTaken (i, j))
+  {
+    cell.sub_score = 0;
+    cell.del_score = 0;
+    cell.ins_score = 0;
+
+    return TRACE_ZERO;
+  } // end if taken, nothing runs through it
+
+  return localCell (theTable.at (i - 1, j - 1), theTable.at (i - 1, j),
+                    theTable.at (i, j - 1), subRow[code2[j-1]], g, h, cell);
+
+} // end topCell function
+
+  // topRefill function:
+  // fills again what changes once the cells of rows firstRow..lastRow,
+  // takenLo[i - firstRow]..takenHi[i - firstRow] in row i, are taken
+
+template <class SCORER>
+static void topRefill (topTable &theTable, string &S1, unsigned char *code2,
+                        const SCORER &sub, int g, int h,
+                        int firstRow, int lastRow,
+                        vector <int> &takenLo, vector <int> &takenHi)
+{
+  int n = theTable.n;
+  int m = theTable.m;
+  int prevLo = m, prevHi = -1;
+  int j = 0;
+
+  for (int i = firstRow; i < n; i++)
+  {
+    int lo = prevLo, hi = -1;
+    int changedLo = m, changedHi = -1;
+    bool bestChanged = false;
+
+    if (prevHi >= 0)
+    {
+      hi = prevHi + 1;
+    } // end if changed above, the cell past it has a new diagonal
+
+    if (i <= lastRow)
+    {
+      lo = min (lo, takenLo[i - firstRow]);
+      hi = max (hi, takenHi[i - firstRow]);
+    } // end if this row has taken cells
+
+    if (hi < 0)
+    {
+      break;
+    } // end if nothing changed in the row above, nothing more will
+
+    const int *subRow = sub.row (S1[i-1]);
+
+    for (j = lo; j < m; j++)
+    {
+      ADP_cell cell;
+      ADP_cell &old = theTable.at (i, j);
+      int code = topCell (theTable, subRow, code2, i, j, g, h, cell);
+      bool same = (cell.sub_score == old.sub_score) &&
+                  (cell.del_score == old.del_score) &&
+                  (cell.ins_score == old.ins_score);
+
+      theTable.T.set (i, j, code);
+
+      if (!same)
+      {
+        if (j == theTable.rowBestJ[i] && cell.sub_score != old.sub_score)
+        {
+          bestChanged = true;
+        }
+
+        old = cell;
+        changedLo = min (changedLo, j);
+        changedHi = j;
+      } // end if the scores went down
+      else if (j >= hi)
+      {
+        break;
+      } // end if the rest of the row is the same as before
+
+    } // end for the columns that can change
+
+    statsCells ( ( (j < m) ? j + 1 : m) - lo);
+
+    if (bestChanged)
+    {
+      theTable.findRowBest (i);
+    }
+
+    prevLo = changedLo;
+    prevHi = changedHi;
+
+  } // end for each row that can change
+
+} // end topRefill function
+
+  // topLocalFill function:
+  // the whole table row by row, then hits alignments one at a time,
+  // refilling after each; stops early once no score is above 0
+
+template <class SCORER>
+static int topLocalFill (topTable &theTable, string &S1, string &S2,
+                          unsigned char *code2, const SCORER &sub,
+                          int g, int h, int k, vector <localHit> &hits)
+{
+  int n = theTable.n;
+  int m = theTable.m;
+
+  for (int j = 0; j < m; j++)
+  {
+    theTable.at (0, j) = edgeCell (0, j, g, h, ALIGN_LOCAL);
+  }
+
+  for (int i = 0; i < n; i++)
+  {
+    theTable.at (i, 0) = edgeCell (i, 0, g, h, ALIGN_LOCAL);
+  } // end zeroeth row and column, all 0
+
+  memset (theTable.taken, 0, ( (size_t) n * m + 7) / 8);
+
+  for (int i = 1; i < n; i++)
+  {
+    const int *subRow = sub.row (S1[i-1]);
+
+    for (int j = 1; j < m; j++)
+    {
+      theTable.T.set (i, j, topCell (theTable, subRow, code2, i, j,
+                                     g, h, theTable.at (i, j)));
+    }
+
+    theTable.findRowBest (i);
+
+  } // end fill every row
+
+  while ( (int) hits.size () < k)
+  {
+    localHit theHit;
+    int bestI = 0;
+
+    for (int i = 1; i < n; i++)
+    {
+      if (theTable.rowBest[i] > theTable.rowBest[bestI])
+      {
+        bestI = i;
+      }
+    } // end find the highest row, the first one on a tie
+
+    if (theTable.rowBest[bestI] <= 0)
+    {
+      break;
+    } // end if nothing left
+
+    theHit.score = theTable.rowBest[bestI];
+    theHit.endI = bestI;
+    theHit.endJ = theTable.rowBestJ[bestI];
+
+    traceBack (theTable.T, S1, S2, theHit.endI, theHit.endJ, 0,
+               ALIGN_LOCAL, theHit.theS1, theHit.theS2);
+
+    theHit.theS1 = reverseVector (theHit.theS1);
+    theHit.theS2 = reverseVector (theHit.theS2);
+
+      // walk the alignment forward to take its cells
+
+    int i = theHit.endI, j = theHit.endJ;
+
+    for (size_t c = 0; c < theHit.theS1.size (); c++)
+    {
+      i -= (theHit.theS1[c] != '-');
+      j -= (theHit.theS2[c] != '-');
+    } // end find where it starts
+
+    theHit.startI = i;
+    theHit.startJ = j;
+
+      // the first row with a taken cell: the one after the start,
+      // or the start's own if the hit opens with an insertion
+      // (h + g > 0, a gap pays for itself)
+
+    int firstRow = theHit.startI + (theHit.theS1[0] != '-');
+    int rows = theHit.endI - firstRow + 1;
+    vector <int> takenLo (rows, m), takenHi (rows, -1);
+
+    for (size_t c = 0; c < theHit.theS1.size (); c++)
+    {
+      i += (theHit.theS1[c] != '-');
+      j += (theHit.theS2[c] != '-');
+
+      theTable.take (i, j);
+      takenLo[i - firstRow] = min (takenLo[i - firstRow], j);
+      takenHi[i - firstRow] = j;
+    } // end for each column
+
+    hits.push_back (theHit);
+
+    if ( (int) hits.size () < k)
+    {
+      topRefill (theTable, S1, code2, sub, g, h, firstRow,
+                 theHit.endI, takenLo, takenHi);
+    }
+  } // end while more to find
+
+  return hits.size ();
+
+} // end topLocalFill function
+
+  // topLocal function:
+  // the k best local alignments of S1 and S2 that share no cell,
+  // best first, into "hits" (fewer if no score above 0 is left)
+  // the table comes from "arena"
+  // returns how many were found, -1 if out of memory
+
+int topLocal (string &S1, string &S2, scoreScheme &scoring, int g, int h,
+               int k, dpArena &arena, vector <localHit> &hits)
+{
+  int n = S1.size () + 1;
+  int m = S2.size () + 1;
+
+  statsMark ();
+  hits.clear ();
+  arena.reset ();
+
+  topTable theTable (n, m, h, arena);
+  unsigned char *code2 = (unsigned char *) arena.take (m);
+
+  if (!theTable.ok () || code2 == NULL)
+  {
+    return -1;
+  } // end if out of memory
+
+  for (int j = 0; j < m - 1; j++)
+  {
+    code2[j] = scoreCode (S2[j]);
+  }
+
+  statsLap (STATS_INIT);
+  statsCells ( (long long) (n - 1) * (m - 1));
+
+  int found = scoreDispatch (scoring, [&] (auto sub)
+  {
+    return topLocalFill (theTable, S1, S2, code2, sub, g, h, k, hits);
+  });
+
+  statsLap (STATS_FILL);
+  statsBytes (arena.peak);
+
+  return found;
+
+} // end topLocal function
+
+#endif
@@ -0,0 +1,267 @@
+/*
+* Cpt_S 471
+* Programming Assignment #1
+*
+* traceback.h
+*
+* Packed traceback for runGlobal / runLocal.  Instead of keeping
+* all three scores of every cell for the backtrace, each cell keeps
+* a 4 bit code, two cells to a byte:
+*
+*   bits 0-1  the state with the highest score in the cell
+*             (0 = substitution, 1 = deletion, 2 = insertion,
+*              3 = every score is 0, local only: the alignment
+*              starts after this cell)
+*   bit 2     the deletion in this cell extends the one above
+*   bit 3     the insertion in this cell extends the one to the left
+*   bit 4     the deletion in this cell opened after an insertion
+*             (else after a substitution)
+*   bit 5     the insertion in this cell opened after a deletion
+*
+* That is all the backtrace ever looks at, so walking the codes
+* gives the same path as walking the full table did.
+*
+* Bits 4 and 5 are only needed when h > 0: with h <= 0 a gap that
+* opens never beats extending the gap of its own kind, so the state
+* of the cell it opened after is never that gap and bits 0-1 of
+* that cell already say where it came from.  With h > 0 the cells
+* take a byte each instead of half (traceWide).
+*
+*/
+
+#ifndef TRACEBACK_H
+#define TRACEBACK_H
+
+#include <string.h>
+#include <iostream>
+#include <vector>
+#include "alignCore.h"
+#include "dpArena.h"
+
+using namespace std;
+
+#define TRACE_STATE 3
+#define TRACE_ZERO 3
+#define TRACE_DEL_EXTEND 4
+#define TRACE_INS_EXTEND 8
+#define TRACE_DEL_FROM_INS 16
+#define TRACE_INS_FROM_DEL 32
+
+  // traceWide function:
+  // true if the codes need bits 4 and 5, a byte a cell
+
+static inline bool traceWide (int h)
+{
+  return h > 0;
+
+} // end traceWide function
+
+  // traceRowBytes function:
+  // bytes a row of m columns of codes takes
+
+static inline size_t traceRowBytes (int m, int h)
+{
+  if (m <= 1)
+  {
+    return 0;
+  }
+
+  return traceWide (h) ? (size_t) m - 1 : (size_t) m / 2;
+
+} // end traceRowBytes function
+
+  // traceMatrix: the 4 bit codes for rows 1..n-1, columns 1..m-1
+  // every row starts on a new byte, and column j sits in nibble j - 1,
+  // so blocks that start on an odd column never share a byte
+  // (h > 0: the 6 bit codes, column j in byte j - 1)
+  // the codes live in "arena" (not cleared, every cell gets set
+  // before it is read); bits is NULL if the arena ran out of memory
+
+struct traceMatrix
+{
+  int n, m;
+  bool wide;
+  size_t rowBytes;
+  unsigned char *bits;
+
+  traceMatrix (int theN, int theM, int h, dpArena &arena)
+  {
+    n = theN;
+    m = theM;
+    wide = traceWide (h);
+    rowBytes = traceRowBytes (m, h);
+    bits = (unsigned char *) arena.take ( (n > 1) ? (n - 1) * rowBytes : 0);
+  }
+
+  void set (int i, int j, int code)
+  {
+    if (wide)
+    {
+      bits[ (size_t) (i - 1) * rowBytes + j - 1] = code;
+      return;
+    } // end if a byte a cell
+
+    code &= 0x0F;
+
+    unsigned char &theByte = bits[ (size_t) (i - 1) * rowBytes + (j - 1) / 2];
+
+    if ( (j - 1) & 1)
+    {
+      theByte = (theByte & 0x0F) | (code << 4);
+    }
+    else
+    {
+      theByte = (theByte & 0xF0) | code;
+    }
+  }
+
+    // the zeroeth row and column have no code, only gaps
+    // (global) or nothing (local) can come from there
+    // (semi-global: gaps in the zeroeth column, nothing in the row)
+
+  int get (int i, int j)
+  {
+    if (i <= 0 || j <= 0)
+    {
+      return TRACE_ZERO;
+    }
+
+    if (wide)
+    {
+      return bits[ (size_t) (i - 1) * rowBytes + j - 1];
+    } // end if a byte a cell
+
+    unsigned char theByte = bits[ (size_t) (i - 1) * rowBytes + (j - 1) / 2];
+
+    return ( (j - 1) & 1) ? (theByte >> 4) : (theByte & 0x0F);
+  }
+};
+
+  // tracePath function:
+  // walks the codes from (i,j) in "state" back to the start,
+  // handing each column to path.step (state, i, j), last column
+  // first: state 0 = S1[i-1] against S2[j-1], 1 = S1[i-1] against
+  // a gap, 2 = a gap against S2[j-1]
+  // mode ALIGN_GLOBAL: runs back to T(0,0), only gaps in the zeroeth
+  // row / column
+  // ALIGN_LOCAL: stops where the scores before the alignment are all 0
+  // ALIGN_SEMIGLOBAL: stops at the zeroeth row, the rest of S2 is free
+  // T is a traceMatrix, or anything else with the same get (i, j)
+
+template <class CODES, class PATH>
+void tracePath (CODES &T, int i, int j, int state, int mode, PATH &path)
+{
+  int code = 0;
+  bool local = (mode == ALIGN_LOCAL);
+
+  while ( (i > 0) || (j > 0) )
+  {
+    if (local && (i == 0 || j == 0) )
+    {
+      break;
+    } // end if local ran into the edge
+
+    if (mode == ALIGN_SEMIGLOBAL && i == 0)
+    {
+      break;
+    } // end if all of S1 is aligned
+
+      // the zeroeth row and column can only be gaps:
+
+    if (j == 0)
+    {
+      state = 1;
+    }
+    else if (i == 0)
+    {
+      state = 2;
+    }
+
+    path.step (state, i, j);
+
+    if (state == 0)
+    {
+      code = T.get (i-1, j-1);
+      state = code & TRACE_STATE;
+
+      i--;
+      j--;
+
+    } // end if substitution
+    else if (state == 1)
+    {
+      code = (j > 0) ? T.get (i, j) : TRACE_DEL_EXTEND;
+
+      if (!(code & TRACE_DEL_EXTEND) )
+      {
+        state = T.get (i-1, j) & TRACE_STATE;
+
+        if (state == 1)
+        {
+          state = (code & TRACE_DEL_FROM_INS) ? 2 : 0;
+        } // end if the deletion above is best but can't open this one
+
+      } // end if this deletion opened the gap
+
+      i--;
+
+    } // end if deletion
+    else if (state == 2)
+    {
+      code = (i > 0) ? T.get (i, j) : TRACE_INS_EXTEND;
+
+      if (!(code & TRACE_INS_EXTEND) )
+      {
+        state = T.get (i, j-1) & TRACE_STATE;
+
+        if (state == 2)
+        {
+          state = (code & TRACE_INS_FROM_DEL) ? 1 : 0;
+        } // end if the insertion to the left is best but can't open this one
+
+      } // end if this insertion opened the gap
+
+      j--;
+
+    } // end else if insertion
+
+    if (local && state == TRACE_ZERO)
+    {
+      break;
+    } // end if the local alignment starts here
+
+  } // end while loop to backtrace
+
+} // end tracePath function
+
+  // charPath: the aligned characters, pushed last column first
+
+struct charPath
+{
+  string &S1;
+  string &S2;
+  vector <char> &theS1;
+  vector <char> &theS2;
+
+  void step (int state, int i, int j)
+  {
+    theS1.push_back ( (state == 2) ? '-' : S1[i-1]);
+    theS2.push_back ( (state == 1) ? '-' : S2[j-1]);
+  }
+};
+
+  // traceBack function:
+  // tracePath into theS1 / theS2 (last column first)
+
+template <class CODES>
+void traceBack (CODES &T, string &S1, string &S2, int i, int j,
+                 int state, int mode,
+                 vector <char> &theS1, vector <char> &theS2)
+{
+  charPath path = { S1, S2, theS1, theS2 };
+
+  tracePath (T, i, j, state, mode, path);
+
+} // end traceBack function
+
+#endif
@@ -0,0 +1,762 @@
+/*
+* Cpt_S 471
+* Programming Assignment #1
+*
+* wavefront.h
+*
+* Fills the DP table for runGlobal / runLocal on several threads.
+* The table is cut into tiles; a tile can be filled once the tile
+* above it and the tile to its left are done, so the tiles run in
+* waves along the anti-diagonals.  Every cell is worked out by the
+* same function as the one thread fill, so the table comes out
+* exactly the same either way.
+*
+* One thread fills the same tiles row by row: a tile's two rolling
+* rows and the codes it writes stay in the L1 cache while it runs,
+* instead of streaming two rows as wide as S2 (24 bytes a column)
+* through the cache for every row of S1.  The tile side comes from
+* the L1 data cache size (wavefrontCacheTile), or from
+* wavefrontTileSize (--tile) if that is set.
+*
+* Only the traceback codes of the table are kept (traceback.h).
+* A tile fills its cells with two rolling rows, reading the row
+* above it and the column to its left from the edges the tiles
+* before it left behind, and leaving its own last row and last
+* column for the tiles after it.
+*
+*/
+
+#ifndef WAVEFRONT_H
+#define WAVEFRONT_H
+
+#include <string.h>
+#include <iostream>
+#include <vector>
+#include <deque>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <math.h>
+#include <unistd.h>
+#include "alignCore.h"
+#include "traceback.h"
+#include "dpArena.h"
+#include "scoring.h"
+
+using namespace std;
+
+  // smallest and largest tile sides (in cells)
+
+#define WAVEFRONT_MIN_TILE 64
+#define WAVEFRONT_MAX_TILE 1024
+
+  // L1 data cache size to assume if the system doesn't say
+
+#define WAVEFRONT_DEFAULT_L1 (32 << 10)
+
+  // wavefrontTileSize: the tile side to use, 0 = from the L1 size
+  // (set by --tile)
+
+int wavefrontTileSize = 0;
+
+  // wavefrontCacheTile function:
+  // the biggest tile whose codes (half a byte a cell) and two rolling
+  // rows (24 bytes a column) fit in the L1 data cache:
+  // tile * tile / 2 + 24 * tile <= L1
+  // (tiles sized to L2 measured no faster than one big tile)
+
+int wavefrontCacheTile ()
+{
+  static int cacheTile = 0;
+
+  if (cacheTile == 0)
+  {
+    long l1 = 0;
+
+#ifdef _SC_LEVEL1_DCACHE_SIZE
+    l1 = sysconf (_SC_LEVEL1_DCACHE_SIZE);
+#endif
+
+    if (l1 <= 0)
+    {
+      l1 = WAVEFRONT_DEFAULT_L1;
+    }
+
+    int tile = (int) sqrt (576.0 + 2.0 * l1) - 24;
+
+    if (tile < WAVEFRONT_MIN_TILE)
+    {
+      tile = WAVEFRONT_MIN_TILE;
+    }
+    if (tile > WAVEFRONT_MAX_TILE)
+    {
+      tile = WAVEFRONT_MAX_TILE;
+    }
+
+    cacheTile = tile;
+  } // end if not worked out yet
+
+  return cacheTile;
+
+} // end wavefrontCacheTile function
+
+  // threadPool: a fixed set of worker threads that run jobs
+  // from a queue, jobs may submit more jobs
+
+struct threadPool
+{
+  vector <thread> workers;
+  deque < function <void ()> > jobs;
+  mutex lock;
+  condition_variable jobReady;
+  condition_variable allDone;
+  int busy;
+  bool stopping;
+
+  threadPool (int count)
+  {
+    busy = 0;
+    stopping = false;
+
+    for (int t = 0; t < count; t++)
+    {
+      workers.push_back (thread (&threadPool::work, this));
+    }
+  }
+
+  ~threadPool ()
+  {
+    {
+      unique_lock <mutex> hold (lock);
+      stopping = true;
+    }
+
+    jobReady.notify_all ();
+
+    for (int t = 0; t < (int) workers.size (); t++)
+    {
+      workers[t].join ();
+    }
+  }
+
+  void submit (function <void ()> job)
+  {
+    {
+      unique_lock <mutex> hold (lock);
+      jobs.push_back (job);
+    }
+
+    jobReady.notify_one ();
+  }
+
+    // wait until the queue is empty and no job is running
+
+  void wait ()
+  {
+    unique_lock <mutex> hold (lock);
+
+    while (!jobs.empty () || busy > 0)
+    {
+      allDone.wait (hold);
+    }
+  }
+
+  void work ()
+  {
+    while (true)
+    {
+      function <void ()> job;
+
+      {
+        unique_lock <mutex> hold (lock);
+
+        while (jobs.empty () && !stopping)
+        {
+          jobReady.wait (hold);
+        }
+
+        if (jobs.empty ())
+        {
+          return;
+        } // end if stopping and nothing left to do
+
+        job = jobs.front ();
+        jobs.pop_front ();
+        busy++;
+      }
+
+      job ();
+
+      {
+        unique_lock <mutex> hold (lock);
+        busy--;
+
+        if (jobs.empty () && busy == 0)
+        {
+          allDone.notify_all ();
+        }
+      }
+
+    } // end loop, take jobs until stopped
+  }
+};
+
+  // globalCell function:
+  // fills in "cell" for the global alignment from the cells
+  // up-left (diag), up and left, and returns its traceback code
+
+static inline int globalCell (ADP_cell &diag, ADP_cell &up, ADP_cell &left,
+                               int score, int g, int h, ADP_cell &cell)
+{
+  int max = 0, ext = 0, open = 0;
+  int code = 0;
+
+    // substitution:
+
+  cell.sub_score = cellMax (diag) + score;
+
+    // Deletion: extend the one above, or open a new one after
+    // the substitution or insertion above (a gap never opens
+    // right after a gap of its own kind)
+
+  ext = up.del_score + g;
+  open = up.sub_score;
+
+  if (up.ins_score > open)
+  {
+    open = up.ins_score;
+    code |= TRACE_DEL_FROM_INS;
+  } // end if the gap would open after an insertion
+
+  open += h + g;
+
+  if (ext >= open)
+  {
+    cell.del_score = ext;
+    code = (code & ~TRACE_DEL_FROM_INS) | TRACE_DEL_EXTEND;
+  }
+  else
+  {
+    cell.del_score = open;
+  }
+
+    // Insertion: extend the one to the left, or open a new one
+    // after the substitution or deletion to the left
+
+  ext = left.ins_score + g;
+  open = left.sub_score;
+
+  if (left.del_score > open)
+  {
+    open = left.del_score;
+    code |= TRACE_INS_FROM_DEL;
+  } // end if the gap would open after a deletion
+
+  open += h + g;
+
+  if (ext >= open)
+  {
+    cell.ins_score = ext;
+    code = (code & ~TRACE_INS_FROM_DEL) | TRACE_INS_EXTEND;
+  }
+  else
+  {
+    cell.ins_score = open;
+  }
+
+  max = cell.sub_score;
+  if (cell.del_score > max)
+  {
+    max = cell.del_score;
+    code |= 1;
+  }
+  if (cell.ins_score > max)
+  {
+    code = (code & ~TRACE_STATE) | 2;
+  }
+
+  return code;
+
+} // end globalCell function
+
+  // localCell function:
+  // same as globalCell but no score goes below zero,
+  // a cell with every score 0 gets the state TRACE_ZERO
+
+static inline int localCell (ADP_cell &diag, ADP_cell &up, ADP_cell &left,
+                              int score, int g, int h, ADP_cell &cell)
+{
+  int max = 0, ext = 0, open = 0;
+  int code = 0;
+
+    // substitution:
+
+  max = cellMax (diag) + score;
+
+  if (max < 0)
+  {
+    max = 0;
+  } // end no negative scores
+
+  cell.sub_score = max;
+
+    // Deletion: extend the one above, or open a new one
+
+  ext = up.del_score + g;
+  open = up.sub_score;
+
+  if (up.ins_score > open)
+  {
+    open = up.ins_score;
+    code |= TRACE_DEL_FROM_INS;
+  } // end if the gap would open after an insertion
+
+  open += h + g;
+
+  if (ext >= open)
+  {
+    max = ext;
+    code = (code & ~TRACE_DEL_FROM_INS) | TRACE_DEL_EXTEND;
+  }
+  else
+  {
+    max = open;
+  }
+
+  if (max < 0)
+  {
+    max = 0;
+  } // end no negative scores
+
+  cell.del_score = max;
+
+    // Insertion: extend the one to the left, or open a new one
+
+  ext = left.ins_score + g;
+  open = left.sub_score;
+
+  if (left.del_score > open)
+  {
+    open = left.del_score;
+    code |= TRACE_INS_FROM_DEL;
+  } // end if the gap would open after a deletion
+
+  open += h + g;
+
+  if (ext >= open)
+  {
+    max = ext;
+    code = (code & ~TRACE_INS_FROM_DEL) | TRACE_INS_EXTEND;
+  }
+  else
+  {
+    max = open;
+  }
+
+  if (max < 0)
+  {
+    max = 0;
+  } // end no negative scores
+
+  cell.ins_score = max;
+
+  max = cell.sub_score;
+  if (cell.del_score > max)
+  {
+    max = cell.del_score;
+    code |= 1;
+  }
+  if (cell.ins_score > max)
+  {
+    max = cell.ins_score;
+    code = (code & ~TRACE_STATE) | 2;
+  }
+  if (max == 0)
+  {
+    code |= TRACE_ZERO;
+  }
+
+  return code;
+
+} // end localCell function
+
+  // edgeCell function:
+  // T(i,j) in the zeroeth row or column, the way runGlobal /
+  // runLocal / runSemiGlobal set them up (ADP_MINUS_INFINITY stands
+  // in for minus infinity)
+  // semi-global: the zeroeth row is free, S1 can start anywhere in S2
+
+static inline ADP_cell edgeCell (int i, int j, int g, int h, int mode)
+{
+  ADP_cell theCell;
+
+  theCell.sub_score = 0;
+  theCell.del_score = 0;
+  theCell.ins_score = 0;
+
+  if (mode == ALIGN_LOCAL || (i == 0 && j == 0) )
+  {
+    return theCell;
+  } // end if all zero
+
+  if (mode == ALIGN_SEMIGLOBAL && i == 0)
+  {
+    theCell.del_score = ADP_MINUS_INFINITY;
+    theCell.ins_score = ADP_MINUS_INFINITY;
+    return theCell;
+  } // end if zeroeth row, no gap to pay for
+
+  theCell.sub_score = ADP_MINUS_INFINITY;
+
+  if (j == 0)
+  {
+    theCell.del_score = (h + (i * g) );
+    theCell.ins_score = ADP_MINUS_INFINITY;
+  } // end if zeroeth column
+  else
+  {
+    theCell.del_score = ADP_MINUS_INFINITY;
+    theCell.ins_score = (h + (j * g) );
+  } // end else, zeroeth row
+
+  return theCell;
+
+} // end edgeCell function
+
+  // fillBlock function:
+  // fills rows rowStart..rowEnd-1, columns colStart..colEnd-1
+  // row by row with two rolling rows, storing only the codes
+  // top: the row above the block, from column colStart - 1 on
+  // side: the column left of the block, one per row
+  // when done, below (from column colStart - 1 on, but the corner
+  // is left alone) holds the block's last row and side its last
+  // column, ready for the blocks after it
+  // for local, keeps the first (row by row) cell with the
+  // highest substitution score in the block
+  // sub: the substitution scorer, code2: the codes of S2 (scoring.h)
+
+template <class SCORER>
+static void fillBlock (traceMatrix &T, string &S1, unsigned char *code2,
+                       int rowStart, int rowEnd, int colStart, int colEnd,
+                       ADP_cell *top, ADP_cell *below, ADP_cell *side,
+                       const SCORER &sub, int g, int h, bool local,
+                       int *highScore, int *maxI, int *maxJ)
+{
+  int width = colEnd - colStart + 1;
+  vector <ADP_cell> prevRow (top, top + width);
+  vector <ADP_cell> curRow (width);
+
+  for (int i = rowStart; i < rowEnd; i++)
+  {
+    const int *subRow = sub.row (S1[i-1]);
+
+    curRow[0] = side[i - rowStart];
+
+    for (int j = colStart; j < colEnd; j++)
+    {
+      int b = j - colStart + 1;
+      int score = subRow[code2[j-1]];
+      int code = 0;
+
+      if (local)
+      {
+        code = localCell (prevRow[b-1], prevRow[b], curRow[b-1],
+                          score, g, h, curRow[b]);
+
+        if (curRow[b].sub_score > *highScore)
+        {
+          *highScore = curRow[b].sub_score;
+          *maxI = i;
+          *maxJ = j;
+        } // end if we have found a higher score, record its position
+
+      } // end if local
+      else
+      {
+        code = globalCell (prevRow[b-1], prevRow[b], curRow[b-1],
+                           score, g, h, curRow[b]);
+      } // end else, global
+
+      T.set (i, j, code);
+
+    } // end inner loop
+
+    side[i - rowStart] = curRow[width - 1];
+    prevRow.swap (curRow);
+
+  } // end outer loop
+
+  for (int b = 1; b < width; b++)
+  {
+    below[b] = prevRow[b];
+  } // end leave the last row for the block below
+
+} // end fillBlock function
+
+  // wavefrontTile function:
+  // the tile side of wavefrontFill: --tile if given, else small
+  // enough to stay in the cache and, with several threads, to have
+  // enough tiles across the shorter side that every thread has work
+  // once the wave gets going
+  // (even, so two tiles never share a byte of T)
+
+int wavefrontTile (int n, int m, int threads)
+{
+  int tile = wavefrontTileSize;
+
+  if (tile <= 0)
+  {
+    tile = wavefrontCacheTile ();
+
+    if (threads > 1)
+    {
+      int shortSide = (n < m) ? n : m;
+      int waveTile = shortSide / (4 * threads);
+
+      if (waveTile < WAVEFRONT_MIN_TILE)
+      {
+        waveTile = WAVEFRONT_MIN_TILE;
+      }
+      if (waveTile < tile)
+      {
+        tile = waveTile;
+      }
+    } // end if several threads
+  } // end if no tile size given
+
+  return tile + (tile & 1);
+
+} // end wavefrontTile function
+
+  // wavefrontBytes function:
+  // memory wavefrontFill takes from the arena, the traceMatrix
+  // (traceback.h) with it
+
+size_t wavefrontBytes (int n, int m, int threads, int h)
+{
+  int tile = wavefrontTile (n, m, threads);
+  size_t tileRows = (n - 1 + tile - 1) / tile;
+  size_t tileCols = (m - 1 + tile - 1) / tile;
+
+  if (n <= 1 || m <= 1)
+  {
+    return 0;
+  }
+
+  return (size_t) (n - 1) * traceRowBytes (m, h) + (tileRows + 1) * m * sizeof (ADP_cell) +
+         tileCols * n * sizeof (ADP_cell) + m;
+
+} // end wavefrontBytes function
+
+  // wavefrontFill function:
+  // fills the traceback codes of T for rows 1..n-1, columns 1..m-1
+  // using "threads" threads, the tile edges come from "arena"
+  // mode ALIGN_GLOBAL: last gets T(n-1,m-1), where the backtrace starts
+  // ALIGN_LOCAL: highScore / maxI / maxJ get the first cell, row by row,
+  // with the highest substitution score, the same as filling the
+  // whole table in order on one thread
+  // ALIGN_SEMIGLOBAL: the global cells with a free zeroeth row,
+  // last / highScore / maxI / maxJ get the first cell of the last row
+  // with the highest score (the end of S2 after it is free)
+  // returns false if out of memory
+
+template <class SCORER>
+bool wavefrontFill (traceMatrix &T, string &S1, string &S2, int n, int m,
+                    const SCORER &sub, int g, int h, int mode,
+                    int threads, dpArena &arena, ADP_cell *last,
+                    int *highScore, int *maxI, int *maxJ)
+{
+  bool local = (mode == ALIGN_LOCAL);
+
+  *highScore = 0;
+  *maxI = 0;
+  *maxJ = 0;
+  *last = edgeCell (n - 1, m - 1, g, h, mode);
+
+  if (mode == ALIGN_SEMIGLOBAL)
+  {
+    *maxI = n - 1;
+    *maxJ = m - 1;
+    *highScore = cellMax (*last);
+  } // end if semi-global, so far the last cell
+
+  if (n <= 1 || m <= 1)
+  {
+    return true;
+  } // end if nothing to fill
+
+  int tile = wavefrontTile (n, m, threads);
+  int tileRows = (n - 1 + tile - 1) / tile;
+  int tileCols = (m - 1 + tile - 1) / tile;
+  int tileCount = tileRows * tileCols;
+
+    // topEdge[r * m + j]: the row above tile row r (all columns),
+    // sideEdge[c * n + i]: the column left of tile column c (all rows)
+
+  ADP_cell *topEdge = (ADP_cell *) arena.take (
+                        (size_t) (tileRows + 1) * m * sizeof (ADP_cell));
+  ADP_cell *sideEdge = (ADP_cell *) arena.take (
+                         (size_t) tileCols * n * sizeof (ADP_cell));
+  unsigned char *code2 = (unsigned char *) arena.take (m);
+
+  if (topEdge == NULL || sideEdge == NULL || code2 == NULL)
+  {
+    return false;
+  } // end if out of memory
+
+  for (int j = 0; j < m - 1; j++)
+  {
+    code2[j] = scoreCode (S2[j]);
+  } // end encode S2 once, not in every row
+
+  for (int j = 0; j < m; j++)
+  {
+    topEdge[j] = edgeCell (0, j, g, h, mode);
+  }
+
+  for (int r = 0; r <= tileRows; r++)
+  {
+    int i = (r * tile < n - 1) ? r * tile : n - 1;
+    topEdge[ (size_t) r * m] = edgeCell (i, 0, g, h, mode);
+  }
+
+  for (int i = 0; i < n; i++)
+  {
+    sideEdge[i] = edgeCell (i, 0, g, h, mode);
+  }
+
+    // waiting[t] = how many of the tiles above / to the left
+    // of tile t are not done yet
+
+  atomic <int> *waiting = new atomic <int> [tileCount];
+  vector <int> tileScore (tileCount, 0);
+  vector <int> tileI (tileCount, 0);
+  vector <int> tileJ (tileCount, 0);
+
+  for (int r = 0; r < tileRows; r++)
+  {
+    for (int c = 0; c < tileCols; c++)
+    {
+      waiting[r * tileCols + c] = (r > 0) + (c > 0);
+    }
+  } // end count what each tile waits for
+
+    // runTile: fill tile (r,c), then pass its last row down and
+    // its last column to the right
+
+  function <void (int, int)> runTile;
+  threadPool *pool = NULL;
+
+  runTile = [&] (int r, int c)
+  {
+    int t = r * tileCols + c;
+    int rowStart = 1 + r * tile;
+    int colStart = 1 + c * tile;
+    int rowEnd = (rowStart + tile < n) ? rowStart + tile : n;
+    int colEnd = (colStart + tile < m) ? colStart + tile : m;
+    ADP_cell *side = &sideEdge[ (size_t) c * n + rowStart];
+
+      // side is only ever read by this tile, so the block can
+      // leave its last column in it
+
+    fillBlock (T, S1, code2, rowStart, rowEnd, colStart, colEnd,
+               &topEdge[ (size_t) r * m + colStart - 1],
+               &topEdge[ (size_t) (r + 1) * m + colStart - 1],
+               side, sub, g, h, local,
+               &tileScore[t], &tileI[t], &tileJ[t]);
+
+    if (c + 1 < tileCols)
+    {
+      for (int i = rowStart; i < rowEnd; i++)
+      {
+        sideEdge[ (size_t) (c + 1) * n + i] = side[i - rowStart];
+      }
+    } // end leave the last column for the tile to the right
+
+      // this tile is done: start the tile below and
+      // the tile to the right if they are ready
+
+    if (pool == NULL)
+    {
+      return;
+    } // end if one thread, the tiles go row by row
+
+    if (r + 1 < tileRows && --waiting[t + tileCols] == 0)
+    {
+      pool->submit ([&runTile, r, c] () { runTile (r + 1, c); });
+    }
+
+    if (c + 1 < tileCols && --waiting[t + 1] == 0)
+    {
+      pool->submit ([&runTile, r, c] () { runTile (r, c + 1); });
+    }
+  };
+
+  if (threads <= 1)
+  {
+    for (int r = 0; r < tileRows; r++)
+    {
+      for (int c = 0; c < tileCols; c++)
+      {
+        runTile (r, c);
+      }
+    }
+  } // end if one thread, every tile in order (so nothing to submit)
+  else
+  {
+    threadPool thePool (threads);
+
+    pool = &thePool;
+    pool->submit ([&runTile] () { runTile (0, 0); });
+    pool->wait ();
+    pool = NULL;
+
+  } // end else, fill with the thread pool
+
+  delete [] waiting;
+
+  *last = topEdge[ (size_t) tileRows * m + m - 1];
+
+  if (mode == ALIGN_SEMIGLOBAL)
+  {
+    ADP_cell *lastRow = &topEdge[ (size_t) tileRows * m];
+
+    for (int j = 0; j < m; j++)
+    {
+      if (j == 0 || cellMax (lastRow[j]) > *highScore)
+      {
+        *highScore = cellMax (lastRow[j]);
+        *maxJ = j;
+        *last = lastRow[j];
+      }
+    } // end for each cell of the last row
+
+    *maxI = n - 1;
+
+    return true;
+
+  } // end if semi-global, the best end in S2
+
+    // high score: highest tile score, ties go to the
+    // cell that comes first row by row
+
+  for (int t = 0; t < tileCount; t++)
+  {
+    if ( (tileScore[t] > *highScore) ||
+         ( (tileScore[t] == *highScore) && (tileScore[t] > 0) &&
+           ( (tileI[t] < *maxI) ||
+             ( (tileI[t] == *maxI) && (tileJ[t] < *maxJ) ) ) ) )
+    {
+      *highScore = tileScore[t];
+      *maxI = tileI[t];
+      *maxJ = tileJ[t];
+    } // end if a better (or earlier) high score
+  } // end for each tile
+
+  return true;
+
+} // end wavefrontFill function
+
+#endif
@@ -4,6 +4,7 @@
  */
  
 #include "ST1.h"
+#include "../../Common/fastaMap.h"
 #include <fstream>
 #include <ctime>
 
@@ -21,20 +22,16 @@ int main(int argc, char *argv[])
 	
 	//*assume at this point, argv[1] and argv[2] are valid inputs
 	
-	//read argv to create an input string
-	string line;
+	//read argv to create an input string: the first record (fastaMap.h)
 	string input_string;
-	ifstream seq_file(argv[1]);
+	fastaFile seq_file;
 	
-	getline(seq_file, line); //discard the first line
-	while(getline(seq_file, line))
+	if (!seq_file.open(argv[1]) || seq_file.records.empty())
 	{
-		if (*line.rbegin() == '\n')
-		{
-			line.erase(line.size()-1);
-		}
-		input_string += line;
+		cout << endl << "Error: no sequence in " << argv[1] << endl << endl;
+		return 0;
 	}
+	input_string = seq_file.records[0].seq.str();
 	
 	seq_file.close();
 	
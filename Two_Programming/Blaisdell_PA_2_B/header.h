@@ -12,6 +12,7 @@
 
 #include <string.h>
 #include <vector>
+#include "../../Common/packedSeq.h"
 
 using namespace std;
 
@@ -37,6 +38,11 @@ typedef struct node
 
 string theData;
 
+// the same text at 2 bits per base, for comparing
+// edge labels a word at a time
+
+packedSeq packedData;
+
 // We will number leaf nodes up from 0:
 // We will number internal nodes up from n:
 
@@ -12,6 +12,7 @@
 #include <fstream>
 #include <chrono>
 #include "header.h"
+#include "../../Common/fastaMap.h"
 
 using namespace chrono;
 
@@ -21,35 +22,18 @@ using namespace chrono;
 
 void readFile (string fileName, string *dataName, string *theString)
 {
-  string line;
-  int i = 1;
-  //cout << "readFile called" << endl;
+  fastaFile inputFile;
 
-  ifstream inputFile (fileName);
+    // the first record of the file (fastaMap.h), its name
+    // is the label up to the first space
 
-    // first line should be information, but verify it
-
-  getline (inputFile, line);
-
-  if (line[0] == '>')
+  if (!inputFile.open (fileName) || inputFile.records.empty ())
   {
-    while (line[i] != ' ' && line[i])
-    {
-      *dataName += (line[i]);
-
-      i++;
-
-    } // end while loop to get data name
-
-    //getline (inputFile, line);
-
-    while (getline (inputFile, line))
-    {
-      theString->append (line);
-
-    } // end read the data in
+    return;
+  } // end if no data
 
-  } // end if data line
+  *dataName = inputFile.records[0].name.str ();
+  *theString = inputFile.records[0].seq.str ();
 
 } // end function readString
 
@@ -145,37 +129,32 @@ int findPath (aNode * parent, int startIndex, int stringLength,
 
       k = parent->child[i]->edgeLabel[1];
 
-      for (j = 0; j < k; j++)
-      {
+        // how far the edge label and the string agree, 32 bases
+        // at a time (packedSeq.h), but no further than the string
+
+      j = packedData.commonPrefix (parent->child[i]->edgeLabel[0],
+                                   startIndex,
+                                   (stringLength < k) ? stringLength : k);
+
         // Two checks:
         // One, if the string length has been exhausted,
         // Two, if we have found a mismatch
-        #ifdef DEBUG
-        cout << "node " << parent->child[i]->edgeLabel[0] + j;
-        cout << " : " << theData[parent->child[i]->edgeLabel[0] + j];
-        cout << " - string " << startIndex + j;
-        cout << ": " << theData[startIndex + j] << endl;
-        #endif
-
-        if ((theData[parent->child[i]->edgeLabel[0] + j]
-            != theData[startIndex + j]) || ((stringLength - j) == 0))
-        {
-          u = parent->child[i];
-          edgePos = j;
-          int newDistSoFar = distSoFar + j;
 
-          #ifdef DEBUG
-          cout << "distSoFar: " << distSoFar;
-          cout << " - j: " << j << endl;
-          cout << "newDistSoFar: " << newDistSoFar << endl;
-          #endif
-
-          return newDistSoFar;
+      if (j < k)
+      {
+        u = parent->child[i];
+        edgePos = j;
+        int newDistSoFar = distSoFar + j;
 
-        } // end if a mismatch is found or stringLength is exhausted
+        #ifdef DEBUG
+        cout << "distSoFar: " << distSoFar;
+        cout << " - j: " << j << endl;
+        cout << "newDistSoFar: " << newDistSoFar << endl;
+        #endif
 
+        return newDistSoFar;
 
-      } // end for loop
+      } // end if a mismatch is found or stringLength is exhausted
 
       // If we get out of the for loop,
       // the edgeLabel is exhausted but the string is not
@@ -1119,6 +1098,7 @@ int main (int argc, char * argv[])
     // append terminating symbol to string:
 
   theData += '$';
+  packedData.assign (theData.data (), theData.length ());
   dataCopy = theData;
   stringSize = theData.length ();
 
@@ -12,6 +12,7 @@
 #include <fstream>
 #include <chrono>
 #include "header.h"
+#include "../../Common/fastaMap.h"
 
 using namespace chrono;
 
@@ -23,35 +24,18 @@ using namespace chrono;
 
 void readFile (string fileName, string *dataName, string *theString)
 {
-  string line;
-  int i = 1;
-  //cout << "readFile called" << endl;
+  fastaFile inputFile;
 
-  ifstream inputFile (fileName);
+    // the first record of the file (fastaMap.h), its name
+    // is the label up to the first space
 
-    // first line should be information, but verify it
-
-  getline (inputFile, line);
-
-  if (line[0] == '>')
+  if (!inputFile.open (fileName) || inputFile.records.empty ())
   {
-    while (line[i] != ' ' && line[i])
-    {
-      *dataName += (line[i]);
-
-      i++;
-
-    } // end while loop to get data name
-
-    //getline (inputFile, line);
-
-    while (getline (inputFile, line))
-    {
-      theString->append (line);
-
-    } // end read the data in
+    return;
+  } // end if no data
 
-  } // end if data line
+  *dataName = inputFile.records[0].name.str ();
+  *theString = inputFile.records[0].seq.str ();
 
 } // end function readString
 